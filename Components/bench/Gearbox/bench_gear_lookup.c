@@ -0,0 +1,175 @@
+/*
+Microbenchmark for decoding the gearbox microswitch bitmask into a gear.
+
+Compares the lookups that used to run on every servo cycle (a linear scan of
+the supported speeds and the binary search tree built by mh400e_util.c) with
+the 4096 entry lookup table. For every approach the cost of each of the 4096
+possible bitmasks is measured and the worst one is reported, since the servo
+thread has to budget for the worst case. Each bitmask is timed several times
+and the fastest repetition is kept, so that preemption by the OS does not show
+up as a worst case.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "gearbox_logic.h"
+#include "gearbox_lookup.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ITERATIONS 4000
+#define REPETITIONS 5
+
+/* Copy of the binary search tree from mh400e_util.c, using malloc() instead
+ * of hal_malloc(). Values are only stored in the leafs, inner nodes hold the
+ * midpoint between the largest key on the left and the smallest on the right. */
+typedef struct TreeNode {
+    unsigned key;
+    unsigned value;
+    struct TreeNode *left;
+    struct TreeNode *right;
+} TreeNodeT;
+
+static TreeNodeT *tree_node_allocate(unsigned key, unsigned value) {
+    TreeNodeT *node = calloc(1, sizeof(TreeNodeT));
+    node->key = key;
+    node->value = value;
+    return node;
+}
+
+static unsigned tree_leaf_left(TreeNodeT *node) {
+    while (node->left != NULL) {
+        node = node->left;
+    }
+    return node->key;
+}
+
+static unsigned tree_leaf_right(TreeNodeT *node) {
+    while (node->right != NULL) {
+        node = node->right;
+    }
+    return node->key;
+}
+
+static TreeNodeT *tree_from_sorted_array(const SupportedSpeed *array, size_t length) {
+    size_t p = 1;
+    while (p < length) {
+        p = p << 1;
+    }
+
+    TreeNodeT *ptr[p];
+    for (size_t i = 0; i < p; i++) {
+        ptr[i] = NULL;
+    }
+    for (size_t i = 0; i < length; i++) {
+        ptr[i * p / length] = tree_node_allocate(array[i].bitmask, array[i].rpm);
+    }
+
+    while (p > 1) {
+        for (size_t i = 0; i < p; i += 2) {
+            if (ptr[i] && ptr[i + 1]) {
+                TreeNodeT *dn = tree_node_allocate(0, 0);
+                dn->left = ptr[i];
+                dn->right = ptr[i + 1];
+                dn->key = (tree_leaf_left(dn->right) + tree_leaf_right(dn->left)) / 2;
+                ptr[i / 2] = dn;
+            } else {
+                ptr[i / 2] = ptr[i] ? ptr[i] : ptr[i + 1];
+            }
+        }
+        p = p >> 1;
+    }
+    return ptr[0];
+}
+
+static TreeNodeT *g_tree;
+
+static unsigned lookup_tree(unsigned bitmask) {
+    /* neutral was special cased before searching the tree */
+    if ((bitmask & 0x000f) == supported_speeds[0].bitmask) {
+        return supported_speeds[0].rpm;
+    }
+
+    TreeNodeT *node = g_tree;
+    while (node->left != NULL || node->right != NULL) {
+        node = (node->key <= bitmask) ? node->right : node->left;
+    }
+    return (node->key == bitmask) ? node->value : 0;
+}
+
+/* The linear scan get_rpm_from_bitmask() used to do */
+static unsigned lookup_linear(unsigned bitmask) {
+    for (size_t i = 0; i < SUPPORTED_SPEEDS_COUNT; ++i) {
+        if (supported_speeds[i].bitmask == bitmask) {
+            return supported_speeds[i].rpm;
+        }
+    }
+    return 0;
+}
+
+static unsigned lookup_table(unsigned bitmask) {
+    return get_rpm_from_bitmask(bitmask);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void run(const char *name, unsigned (*lookup)(unsigned)) {
+    /* volatile to keep the compiler from hoisting the lookup out of the loop */
+    volatile unsigned input;
+    volatile unsigned sink;
+    double worst = 0;
+    double total = 0;
+    unsigned worst_bitmask = 0;
+
+    for (unsigned bitmask = 0; bitmask < GEARBOX_BITMASK_COUNT; ++bitmask) {
+        input = bitmask;
+        double cost = 0;
+        for (int r = 0; r < REPETITIONS; ++r) {
+            const double start = now_ns();
+            for (int i = 0; i < ITERATIONS; ++i) {
+                sink = lookup(input);
+            }
+            const double repetition = (now_ns() - start) / ITERATIONS;
+            if (r == 0 || repetition < cost) {
+                cost = repetition;
+            }
+        }
+        total += cost;
+        if (cost > worst) {
+            worst = cost;
+            worst_bitmask = bitmask;
+        }
+    }
+    (void)sink;
+
+    printf(
+        "%-12s mean %6.2f ns   worst %6.2f ns (bitmask %4u)\n", name,
+        total / GEARBOX_BITMASK_COUNT, worst, worst_bitmask
+    );
+}
+
+int main(void) {
+    /* the tree was built from an array sorted by bitmask */
+    SupportedSpeed sorted[SUPPORTED_SPEEDS_COUNT];
+    for (size_t i = 0; i < SUPPORTED_SPEEDS_COUNT; ++i) {
+        sorted[i] = supported_speeds[i];
+        for (size_t j = i; j > 0 && sorted[j - 1].bitmask > sorted[j].bitmask; --j) {
+            const SupportedSpeed tmp = sorted[j];
+            sorted[j] = sorted[j - 1];
+            sorted[j - 1] = tmp;
+        }
+    }
+    g_tree = tree_from_sorted_array(sorted, SUPPORTED_SPEEDS_COUNT);
+
+    printf("Cost per bitmask -> gear lookup over all %zu bitmasks:\n", GEARBOX_BITMASK_COUNT);
+    run("linear scan", lookup_linear);
+    run("search tree", lookup_tree);
+    run("lookup table", lookup_table);
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*
+Benchmark of the lubrication schedule, evaluated on every servo cycle versus
+evaluated only at the deadlines returned by lubricate().
+
+The servo thread runs at 1 kHz with the default config of lubrication.comp and
+a pump that reaches its pressure 2s after it started. Three ways to drive
+lubricate() are compared:
+
+- every cycle: lubricate() is called on each cycle, as lubrication.comp used to
+- skipping: each cycle only checks the deadline and the inputs, like
+  lubrication.comp does now
+- fast forward: an offline simulation that jumps from one deadline or input
+  change to the next
+
+All of them have to end in the same state with the same last cycle end time.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "lubrication_logic.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define PERIOD LUBRICATION_MILLISECONDS(1)
+#define DAY (LUBRICATION_MINUTES(60) * 24)
+#define YEAR (DAY * 365)
+#define PRESSURE_BUILDUP LUBRICATION_SECONDS(2)
+
+static const LubricationConfig config = {
+    .enabled = true,
+    .interval = LUBRICATION_MINUTES(16),
+    .pressure_wait = LUBRICATION_SECONDS(60),
+    .hold = LUBRICATION_SECONDS(15)
+};
+
+typedef struct {
+    LubricationState state;
+    unsigned long long evaluations;
+} Result;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static bool pressure_ok(const LubricationState *state, LubricationTime time) {
+    return (state->state == LUBRICATION_STATE_BUILDING_PRESSURE) &&
+           (time - state->building_pressure_start_time >= PRESSURE_BUILDUP);
+}
+
+/* Time at which pressure_ok() changes next, assuming the state stays the same */
+static LubricationTime pressure_edge(const LubricationState *state) {
+    if (state->state != LUBRICATION_STATE_BUILDING_PRESSURE) {
+        return LUBRICATION_NEVER;
+    }
+    return state->building_pressure_start_time + PRESSURE_BUILDUP;
+}
+
+static Result every_cycle(LubricationTime duration) {
+    Result result = {.state = {.state = LUBRICATION_STATE_INITIALIZING}};
+
+    for (LubricationTime time = PERIOD; time <= duration; time += PERIOD) {
+        const LubricationSignals input = {
+            .is_motion_enabled = true, .is_pressure_ok = pressure_ok(&result.state, time)
+        };
+        lubricate(time, input, &result.state, config);
+        result.evaluations++;
+    }
+    return result;
+}
+
+static Result skipping(LubricationTime duration) {
+    Result result = {.state = {.state = LUBRICATION_STATE_INITIALIZING}};
+    LubricationTime deadline = 0;
+    bool last_pressure = false;
+
+    for (LubricationTime time = PERIOD; time <= duration; time += PERIOD) {
+        const bool pressure = pressure_ok(&result.state, time);
+        if ((time < deadline) && (pressure == last_pressure)) {
+            continue;
+        }
+        const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = pressure};
+        deadline = lubricate(time, input, &result.state, config);
+        last_pressure = pressure;
+        result.evaluations++;
+    }
+    return result;
+}
+
+static Result fast_forward(LubricationTime duration) {
+    Result result = {.state = {.state = LUBRICATION_STATE_INITIALIZING}};
+    LubricationTime time = PERIOD;
+
+    while (time <= duration) {
+        const LubricationSignals input = {
+            .is_motion_enabled = true, .is_pressure_ok = pressure_ok(&result.state, time)
+        };
+        LubricationTime next = lubricate(time, input, &result.state, config);
+        result.evaluations++;
+
+        const LubricationTime edge = pressure_edge(&result.state);
+        next = (edge < next) ? edge : next;
+        /* the first servo cycle at or after the next event */
+        next = (next + PERIOD - 1) / PERIOD * PERIOD;
+        time = (next > time) ? next : time + PERIOD;
+    }
+    return result;
+}
+
+static Result run(const char *name, Result (*simulate)(LubricationTime), LubricationTime duration) {
+    const double start = now_ns();
+    const Result result = simulate(duration);
+    const double elapsed = now_ns() - start;
+
+    printf(
+        "%-12s %4lld days  %12.3f ms  %11llu evaluations  %8.3f ns per simulated cycle\n", name,
+        (long long)(duration / DAY), elapsed / 1e6, result.evaluations,
+        elapsed / (double)(duration / PERIOD)
+    );
+    return result;
+}
+
+static bool same(const Result *a, const Result *b) {
+    return (a->state.state == b->state.state) &&
+           (a->state.last_cycle_end_time == b->state.last_cycle_end_time);
+}
+
+int main(void) {
+    printf("Lubrication schedule at a 1 kHz servo period:\n");
+    const Result reference = run("every cycle", every_cycle, DAY);
+    const Result skipped = run("skipping", skipping, DAY);
+    const Result forwarded = run("fast forward", fast_forward, DAY);
+    run("fast forward", fast_forward, YEAR);
+
+    if (!same(&reference, &skipped) || !same(&reference, &forwarded)) {
+        printf("MISMATCH: the deadline driven evaluation ended in a different state\n");
+        return 1;
+    }
+    return 0;
+}
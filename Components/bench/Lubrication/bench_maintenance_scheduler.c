@@ -0,0 +1,97 @@
+/*
+Benchmark of the maintenance scheduler for 1 to 16 tasks.
+
+The servo thread runs at 1 kHz for a simulated day. Each cycle does what
+maintenance.comp does: compare the config of one task, check the tasks waiting
+for their confirmation and evaluate the due tasks. The confirmation arrives 2s
+after a task requested it.
+
+The tasks have intervals of 16 to 31 minutes, so they are due at different
+times. The cost per cycle should not grow with the number of tasks, only the
+number of evaluations does.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "maintenance_scheduler.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define PERIOD LUBRICATION_MILLISECONDS(1)
+#define DAY (LUBRICATION_MINUTES(60) * 24)
+#define CONFIRM_DELAY LUBRICATION_SECONDS(2)
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static LubricationConfig task_config(unsigned task) {
+    const LubricationConfig config = {
+        .enabled = true,
+        .interval = LUBRICATION_MINUTES(16 + task),
+        .pressure_wait = LUBRICATION_SECONDS(60),
+        .hold = LUBRICATION_SECONDS(15)
+    };
+    return config;
+}
+
+static bool confirmed(const MaintenanceScheduler *scheduler, unsigned task, LubricationTime time) {
+    const LubricationState *cycle = &scheduler->tasks[task].cycle;
+    return (cycle->state == LUBRICATION_STATE_BUILDING_PRESSURE) &&
+           (time - cycle->building_pressure_start_time >= CONFIRM_DELAY);
+}
+
+static void run(unsigned task_count) {
+    static MaintenanceScheduler scheduler;
+    unsigned long long evaluations = 0;
+    unsigned cursor = 0;
+    unsigned errors = 0;
+
+    maintenance_init(&scheduler, task_count);
+    for (unsigned task = 0; task < task_count; task++) {
+        maintenance_configure(&scheduler, task, 0, task_config(task));
+    }
+
+    const double start = now_ns();
+    for (LubricationTime time = PERIOD; time <= DAY; time += PERIOD) {
+        unsigned task;
+
+        maintenance_configure(&scheduler, cursor, time, task_config(cursor));
+        cursor = (cursor + 1 < task_count) ? cursor + 1 : 0;
+        maintenance_set_motion_enabled(&scheduler, time, true);
+
+        for (uint32_t waiting = scheduler.awaiting_confirmation; waiting != 0;
+             waiting &= waiting - 1) {
+            task = (unsigned)__builtin_ctz(waiting);
+            if (confirmed(&scheduler, task, time)) {
+                maintenance_wake(&scheduler, task, time);
+            }
+        }
+
+        while (maintenance_next_due(&scheduler, time, &task)) {
+            maintenance_evaluate(&scheduler, task, time, confirmed(&scheduler, task, time));
+            evaluations++;
+        }
+    }
+    const double elapsed = now_ns() - start;
+
+    for (unsigned task = 0; task < task_count; task++) {
+        errors += scheduler.tasks[task].cycle.state == LUBRICATION_STATE_ERROR;
+    }
+    printf(
+        "%2u tasks  %10.3f ms  %8llu evaluations  %6.3f ns per cycle%s\n", task_count,
+        elapsed / 1e6, evaluations, elapsed / (double)(DAY / PERIOD),
+        errors ? "  ERROR STATE" : ""
+    );
+}
+
+int main(void) {
+    printf("Maintenance scheduler, one simulated day at a 1 kHz servo period:\n");
+    for (unsigned task_count = 1; task_count <= MAINTENANCE_MAX_TASKS; task_count *= 2) {
+        run(task_count);
+    }
+    return 0;
+}
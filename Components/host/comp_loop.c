@@ -0,0 +1,126 @@
+/*
+Runs the function of one component built by tools/hal/host_comp.py in a loop,
+as fast as the CPU allows, e.g. under perf or valgrind.
+
+The component is selected at compile time: HOST_COMPONENT is its name, e.g.
+mh400e_gearbox, and the CMake target NAME_loop defines it. Every call gets the
+simulated period. --set NAME=VALUE sets a param or, if there is no param of
+that name, an input pin once before the loop, all other inputs keep their
+defaults, so the loop measures the cycle of an idle component.
+
+Usage: NAME_loop [--cycles N] [--period-ns NS] [--personality P]
+                 [--modparam NAME=VALUE]... [--set NAME=VALUE]...
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "hal_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_STRING_(x) #x
+#define HOST_STRING(x) HOST_STRING_(x)
+#define HOST_FUNCTION__(component, function) component##_host_##function
+#define HOST_FUNCTION_(component, function) HOST_FUNCTION__(component, function)
+#define HOST_FUNCTION(function) HOST_FUNCTION_(HOST_COMPONENT, function)
+
+#include HOST_STRING(HOST_COMPONENT_HEADER)
+
+/* Split NAME=VALUE, returns NULL without a value */
+static const char *split_value(char *assignment) {
+    char *value = strchr(assignment, '=');
+
+    if (value != NULL) {
+        *value++ = '\0';
+    }
+    return value;
+}
+
+static int usage(void) {
+    fprintf(
+        stderr,
+        "usage: %s_loop [--cycles N] [--period-ns NS] [--personality P] "
+        "[--modparam NAME=VALUE]... [--set NAME=VALUE]...\n",
+        HOST_STRING(HOST_COMPONENT)
+    );
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    char prefix[64];
+    struct __comp_state *inst;
+    struct timespec start;
+    struct timespec end;
+    long long cycles = 1000000;
+    long long cycle;
+    long period = 1000000;
+    long personality = 0;
+    double elapsed;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((i + 1 == argc) || (argv[i][0] != '-')) {
+            return usage();
+        }
+        if (strcmp(argv[i], "--cycles") == 0) {
+            cycles = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--period-ns") == 0) {
+            period = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--personality") == 0) {
+            personality = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--modparam") == 0) {
+            const char *value = split_value(argv[++i]);
+
+            if ((value == NULL) || (hal_host_set_modparam(argv[i], atoi(value)) != 0)) {
+                fprintf(stderr, "unknown module param %s\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--set") == 0) {
+            /* params and pins are set once the component exists */
+            i++;
+        } else {
+            return usage();
+        }
+    }
+    if ((cycles <= 0) || (period <= 0)) {
+        return usage();
+    }
+
+    /* Like halcompile, the instance of a singleton is named after the component */
+    snprintf(prefix, sizeof(prefix), "%s", HOST_STRING(HOST_COMPONENT));
+    for (i = 0; prefix[i] != '\0'; i++) {
+        prefix[i] = (prefix[i] == '_') ? '-' : prefix[i];
+    }
+    inst = HOST_FUNCTION(new)(prefix, personality);
+    if (inst == NULL) {
+        fprintf(stderr, "can not create %s\n", prefix);
+        return 2;
+    }
+    for (i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--set") == 0) {
+            const char *value = split_value(argv[++i]);
+
+            if ((value == NULL) || ((HOST_FUNCTION(set_param)(inst, argv[i], atof(value)) != 0) &&
+                                    (HOST_FUNCTION(set_pin)(inst, argv[i], atof(value)) != 0))) {
+                fprintf(stderr, "unknown param or input pin %s\n", argv[i]);
+                return 2;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (cycle = 0; cycle < cycles; cycle++) {
+        HOST_FUNCTION(run)(inst, period);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf(
+        "%s: %lld cycles of %.3f ms in %.3f s, %.1f ns per cycle\n", prefix, cycles,
+        (double)period * 1e-6, elapsed, elapsed * 1e9 / (double)cycles
+    );
+    return 0;
+}
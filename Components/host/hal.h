@@ -0,0 +1,33 @@
+/*
+Host replacement of the LinuxCNC hal.h for components built by
+tools/hal/host_comp.py, only what the components in this repository use.
+
+Pins and params are plain memory owned by the host program, nothing is shared
+between processes.
+*/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include "rtapi.h"
+
+typedef double real_t;
+
+typedef volatile bool hal_bit_t;
+typedef volatile real_t hal_float_t;
+typedef volatile rtapi_u32 hal_u32_t;
+typedef volatile rtapi_s32 hal_s32_t;
+
+typedef enum { HAL_IN = 16, HAL_OUT = 32, HAL_IO = (HAL_IN | HAL_OUT) } hal_pin_dir_t;
+typedef enum { HAL_RO = 64, HAL_RW = 192 } hal_param_dir_t;
+
+void *hal_malloc(long size);
+
+int hal_pin_bit_newf(hal_pin_dir_t dir, hal_bit_t **data_ptr_addr, int comp_id, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+int hal_pin_u32_newf(hal_pin_dir_t dir, hal_u32_t **data_ptr_addr, int comp_id, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+int hal_param_u32_newf(hal_param_dir_t dir, hal_u32_t *data_addr, int comp_id, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+#endif // HAL_H
@@ -0,0 +1,214 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "hal_host.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HAL_HOST_MAX_NAMES 1024
+#define HAL_HOST_MAX_SHMEM 16
+#define HAL_HOST_NAME_LENGTH 48
+
+typedef struct {
+    char name[HAL_HOST_NAME_LENGTH];
+    void *data;
+} HalHostEntry;
+
+typedef struct {
+    HalHostEntry entries[HAL_HOST_MAX_NAMES];
+    unsigned count;
+} HalHostRegistry;
+
+static HalHostRegistry runtime_pins;
+static HalHostRegistry runtime_params;
+static HalHostRegistry modparams;
+
+static struct {
+    int key;
+    void *memory;
+} shared_memory[HAL_HOST_MAX_SHMEM];
+static unsigned shared_memory_count = 0;
+
+static int message_level = RTAPI_MSG_ERR;
+static bool fixed_clocks = false;
+static long long clocks = 0;
+
+static int registry_add(HalHostRegistry *registry, const char *fmt, va_list args, void *data) {
+    HalHostEntry *entry;
+
+    if (registry->count >= HAL_HOST_MAX_NAMES) {
+        return -ENOMEM;
+    }
+    entry = &registry->entries[registry->count];
+    if (vsnprintf(entry->name, sizeof(entry->name), fmt, args) >= (int)sizeof(entry->name)) {
+        return -EINVAL;
+    }
+    entry->data = data;
+    registry->count++;
+    return 0;
+}
+
+static void *registry_find(const HalHostRegistry *registry, const char *name) {
+    unsigned i;
+
+    for (i = 0; i < registry->count; i++) {
+        if (strcmp(registry->entries[i].name, name) == 0) {
+            return registry->entries[i].data;
+        }
+    }
+    return NULL;
+}
+
+void rtapi_print(const char *fmt, ...) {
+    va_list args;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+void rtapi_print_msg(msg_level_t level, const char *fmt, ...) {
+    va_list args;
+
+    if ((int)level > message_level) {
+        return;
+    }
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+void rtapi_set_msg_level(int level) { message_level = level; }
+
+long long rtapi_get_time(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+long long rtapi_get_clocks(void) { return fixed_clocks ? clocks : rtapi_get_time(); }
+
+void hal_host_set_clocks(long long value) {
+    fixed_clocks = true;
+    clocks = value;
+}
+
+/* Shared memory is plain memory of the process, found again by its key */
+int rtapi_shmem_new(int key, int module_id, unsigned long size) {
+    unsigned i;
+
+    (void)module_id;
+    for (i = 0; i < shared_memory_count; i++) {
+        if (shared_memory[i].key == key) {
+            return (int)i;
+        }
+    }
+    if (shared_memory_count >= HAL_HOST_MAX_SHMEM) {
+        return -ENOMEM;
+    }
+    shared_memory[shared_memory_count].memory = calloc(1, size);
+    if (shared_memory[shared_memory_count].memory == NULL) {
+        return -ENOMEM;
+    }
+    shared_memory[shared_memory_count].key = key;
+    return (int)shared_memory_count++;
+}
+
+int rtapi_shmem_getptr(int shmem_id, void **ptr) {
+    if ((shmem_id < 0) || ((unsigned)shmem_id >= shared_memory_count)) {
+        return -EINVAL;
+    }
+    *ptr = shared_memory[shmem_id].memory;
+    return 0;
+}
+
+/* The memory stays valid until the program ends */
+int rtapi_shmem_delete(int shmem_id, int module_id) {
+    (void)module_id;
+    return ((shmem_id < 0) || ((unsigned)shmem_id >= shared_memory_count)) ? -EINVAL : 0;
+}
+
+void hal_host_register_modparam(const char *name, int *value) {
+    HalHostEntry *entry;
+
+    if (modparams.count >= HAL_HOST_MAX_NAMES) {
+        return;
+    }
+    entry = &modparams.entries[modparams.count++];
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    entry->data = value;
+}
+
+/* Module params are registered as "component.name", a name without the
+ * component sets the module param of every component that has one */
+int hal_host_set_modparam(const char *name, int value) {
+    int result = -1;
+    unsigned i;
+
+    for (i = 0; i < modparams.count; i++) {
+        const char *registered = modparams.entries[i].name;
+        const char *separator = strchr(registered, '.');
+
+        if ((strcmp(registered, name) == 0) ||
+            ((strchr(name, '.') == NULL) && (separator != NULL) &&
+             (strcmp(separator + 1, name) == 0))) {
+            *(int *)modparams.entries[i].data = value;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+void *hal_malloc(long size) { return calloc(1, (size_t)size); }
+
+int hal_pin_bit_newf(hal_pin_dir_t dir, hal_bit_t **data_ptr_addr, int comp_id, const char *fmt, ...) {
+    va_list args;
+    int result;
+
+    (void)dir;
+    (void)comp_id;
+    *data_ptr_addr = hal_malloc(sizeof(hal_bit_t));
+    if (*data_ptr_addr == NULL) {
+        return -ENOMEM;
+    }
+    va_start(args, fmt);
+    result = registry_add(&runtime_pins, fmt, args, (void *)*data_ptr_addr);
+    va_end(args);
+    return result;
+}
+
+int hal_pin_u32_newf(hal_pin_dir_t dir, hal_u32_t **data_ptr_addr, int comp_id, const char *fmt, ...) {
+    va_list args;
+    int result;
+
+    (void)dir;
+    (void)comp_id;
+    *data_ptr_addr = hal_malloc(sizeof(hal_u32_t));
+    if (*data_ptr_addr == NULL) {
+        return -ENOMEM;
+    }
+    va_start(args, fmt);
+    result = registry_add(&runtime_pins, fmt, args, (void *)*data_ptr_addr);
+    va_end(args);
+    return result;
+}
+
+int hal_param_u32_newf(hal_param_dir_t dir, hal_u32_t *data_addr, int comp_id, const char *fmt, ...) {
+    va_list args;
+    int result;
+
+    (void)dir;
+    (void)comp_id;
+    va_start(args, fmt);
+    result = registry_add(&runtime_params, fmt, args, (void *)data_addr);
+    va_end(args);
+    return result;
+}
+
+void *hal_host_pin(const char *name) { return registry_find(&runtime_pins, name); }
+
+void *hal_host_param(const char *name) { return registry_find(&runtime_params, name); }
@@ -0,0 +1,28 @@
+/*
+Functions for host programs that drive components built by
+tools/hal/host_comp.py, e.g. the trace replay.
+*/
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "hal.h"
+
+/* Set a module param, call this before the component is created. The name is
+ * either "component.param" or only "param" for all components that have it.
+ * Returns 0 or -1 if no component has such a module param. */
+int hal_host_set_modparam(const char *name, int value);
+
+/* Pins created at runtime with one of the hal_*_newf() functions by name,
+ * e.g. "mh400e-gearbox.cost-max". Returns NULL if there is no such pin. */
+void *hal_host_pin(const char *name);
+
+/* Params created at runtime with hal_param_*_newf() by name */
+void *hal_host_param(const char *name);
+
+/* Set the value rtapi_get_clocks() returns next, a host program driving a
+ * component faster than realtime sets it before each call. Without it the
+ * monotonic clock of the host is used. */
+void hal_host_set_clocks(long long clocks);
+
+#endif // HAL_HOST_H
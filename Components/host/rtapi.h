@@ -0,0 +1,52 @@
+/*
+Host replacement of the LinuxCNC rtapi.h for components built by
+tools/hal/host_comp.py, only what the components in this repository use.
+*/
+
+#ifndef RTAPI_H
+#define RTAPI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef int32_t rtapi_s32;
+typedef uint32_t rtapi_u32;
+typedef int64_t rtapi_s64;
+typedef uint64_t rtapi_u64;
+
+typedef enum {
+    RTAPI_MSG_NONE = 0,
+    RTAPI_MSG_ERR,
+    RTAPI_MSG_WARN,
+    RTAPI_MSG_INFO,
+    RTAPI_MSG_DBG,
+    RTAPI_MSG_ALL
+} msg_level_t;
+
+void rtapi_print(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void rtapi_print_msg(msg_level_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/* Messages above this level are dropped, RTAPI_MSG_ERR unless changed */
+void rtapi_set_msg_level(int level);
+
+long long rtapi_get_time(void);
+long long rtapi_get_clocks(void);
+
+int rtapi_shmem_new(int key, int module_id, unsigned long size);
+int rtapi_shmem_getptr(int shmem_id, void **ptr);
+int rtapi_shmem_delete(int shmem_id, int module_id);
+
+#define rtapi_snprintf snprintf
+
+/* Module params are registered as "component.name", so that a host program can
+ * set them with hal_host_set_modparam() before it creates the component. The
+ * sources generated by host_comp.py define HAL_HOST_COMPONENT. */
+void hal_host_register_modparam(const char *name, int *value);
+
+#define RTAPI_MP_INT(var, description)                                                           \
+    __attribute__((constructor)) static void rtapi_mp_##var(void) {                              \
+        hal_host_register_modparam(HAL_HOST_COMPONENT "." #var, &(var));                         \
+    }
+
+#endif // RTAPI_H
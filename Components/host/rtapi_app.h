@@ -0,0 +1,8 @@
+/* Host replacement of the LinuxCNC rtapi_app.h, see rtapi.h */
+
+#ifndef RTAPI_APP_H
+#define RTAPI_APP_H
+
+#include "rtapi.h"
+
+#endif // RTAPI_APP_H
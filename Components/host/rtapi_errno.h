@@ -0,0 +1,8 @@
+/* Host replacement of the LinuxCNC rtapi_errno.h, see rtapi.h */
+
+#ifndef RTAPI_ERRNO_H
+#define RTAPI_ERRNO_H
+
+#include <errno.h>
+
+#endif // RTAPI_ERRNO_H
@@ -0,0 +1,8 @@
+/* Host replacement of the LinuxCNC rtapi_math.h, see rtapi.h */
+
+#ifndef RTAPI_MATH_H
+#define RTAPI_MATH_H
+
+#include <math.h>
+
+#endif // RTAPI_MATH_H
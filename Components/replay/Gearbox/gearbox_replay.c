@@ -0,0 +1,392 @@
+/*
+Replay of a trace recorded by mh400e_gearbox_trace through the gearbox logic.
+
+The mh400e_gearbox component is built for the host by tools/hal/host_comp.py,
+neither halcompile nor a running HAL is needed. Every recorded cycle sets all
+inputs of the component (microswitches, spindle-stopped, estop-in,
+tool-change, spindle-speed-reached, the requested and the preselected rpm and
+the spindle override) and runs it once, as fast as the CPU allows. The
+component writes its own trace record like on the machine, the outputs, the
+state and the gear in it are compared against the recorded ones and the first
+divergence is reported.
+
+The rpms are recorded rounded to whole rpm and the override to 1/1000, a
+decision right at a gear boundary may replay differently. Params are not
+recorded, they can be set with --set NAME=VALUE.
+
+Usage: gearbox_replay [--set NAME=VALUE]... [--period-ns NS] [--quiet] TRACE
+
+Exits with 0 if the replay matches the trace, 1 at the first divergence and 2
+if the trace could not be read.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "gearbox_trace.h"
+#include "hal_host.h"
+#include "mh400e_gearbox_host.h"
+#include "trace_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Recorded records shown before a divergence */
+#define CONTEXT_RECORDS 8
+
+/* Records read from the file at once */
+#define READ_CHUNK 4096
+
+/* Output pins in the bit order of GearboxTraceRecord.outputs */
+static const char *OUTPUT_NAMES[] = {
+    "motor-lowspeed",   "reducer-motor", "midrange-motor", "input-stage-motor",
+    "reverse-direction", "start-gear-shift", "twitch-cw",  "twitch-ccw",
+    "stop-spindle",     "spindle-at-speed", "estop-out"
+};
+
+static const char *STATE_NAMES[] = {"idle", "shifting", "moving", "stopping", "spinup", "estop"};
+
+/* Input pins in the bit order of GearboxTraceRecord.inputs */
+static const char *SWITCH_NAMES[] = {
+    "reducer-left", "reducer-right", "reducer-center", "reducer-left-center",
+    "middle-left",  "middle-right",  "middle-center",  "middle-left-center",
+    "input-left",   "input-right",   "input-center",   "input-left-center"
+};
+
+typedef struct {
+    struct __comp_state *gearbox;
+    TraceRing *ring;
+    hal_bit_t *switches[12];
+    hal_bit_t *spindle_stopped;
+    hal_bit_t *estop_in;
+    hal_bit_t *tool_change;
+    hal_bit_t *speed_reached;
+    hal_float_t *requested_rpm;
+    hal_float_t *preselect_rpm;
+    hal_float_t *override;
+    long period;
+} Replay;
+
+typedef struct {
+    FILE *file;
+    GearboxTraceRecord records[READ_CHUNK];
+    long offset; /* File position of records[0] */
+    size_t count;
+    size_t next;
+    unsigned sessions;
+} TraceReader;
+
+static const char *state_name(unsigned state) {
+    return (state < sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0])) ? STATE_NAMES[state] : "?";
+}
+
+static hal_bit_t *input_pin(Replay *replay, const char *name) {
+    return *(hal_bit_t **)mh400e_gearbox_host_pin(replay->gearbox, name);
+}
+
+static hal_float_t *input_float_pin(Replay *replay, const char *name) {
+    return *(hal_float_t **)mh400e_gearbox_host_pin(replay->gearbox, name);
+}
+
+static int replay_init(Replay *replay, long period) {
+    void *memory = NULL;
+    unsigned i;
+
+    /* The trace ring of the component is where the produced records come from */
+    hal_host_set_modparam("trace", 1);
+    hal_host_set_clocks(0);
+    replay->gearbox = mh400e_gearbox_host_new("mh400e-gearbox", 0);
+    if (replay->gearbox == NULL) {
+        return -1;
+    }
+    if (rtapi_shmem_getptr(rtapi_shmem_new(GEARBOX_TRACE_KEY, 0, 0), &memory) != 0) {
+        return -1;
+    }
+    replay->ring = memory;
+    if (!trace_ring_valid(replay->ring, sizeof(GearboxTraceRecord))) {
+        return -1;
+    }
+
+    for (i = 0; i < 12; i++) {
+        replay->switches[i] = input_pin(replay, SWITCH_NAMES[i]);
+    }
+    replay->spindle_stopped = input_pin(replay, "spindle-stopped");
+    replay->estop_in = input_pin(replay, "estop-in");
+    replay->tool_change = input_pin(replay, "tool-change");
+    replay->speed_reached = input_pin(replay, "spindle-speed-reached");
+    replay->requested_rpm = input_float_pin(replay, "spindle-speed-in-abs");
+    replay->preselect_rpm = input_float_pin(replay, "spindle-speed-preselect");
+    replay->override = input_float_pin(replay, "spindle-override");
+    replay->period = period;
+    return 0;
+}
+
+/* Run one cycle with the inputs of a recorded record, returns the record the
+ * component traced */
+static GearboxTraceRecord replay_cycle(Replay *replay, const GearboxTraceRecord *recorded) {
+    GearboxTraceRecord produced = {0};
+    unsigned i;
+
+    for (i = 0; i < 12; i++) {
+        *replay->switches[i] = (recorded->inputs >> i) & 1;
+    }
+    *replay->spindle_stopped = (recorded->inputs & GEARBOX_TRACE_IN_SPINDLE_STOPPED) != 0;
+    *replay->estop_in = (recorded->inputs & GEARBOX_TRACE_IN_ESTOP) != 0;
+    *replay->tool_change = (recorded->inputs & GEARBOX_TRACE_IN_TOOL_CHANGE) != 0;
+    *replay->speed_reached = (recorded->inputs & GEARBOX_TRACE_IN_SPEED_REACHED) != 0;
+    *replay->requested_rpm = recorded->requested_rpm;
+    *replay->preselect_rpm = recorded->preselect_rpm;
+    *replay->override = recorded->override_permille / 1000.0f;
+
+    mh400e_gearbox_host_run(replay->gearbox, replay->period);
+    trace_ring_pop(replay->ring, &produced, 1);
+    return produced;
+}
+
+static bool same_behaviour(const GearboxTraceRecord *a, const GearboxTraceRecord *b) {
+    return (a->inputs == b->inputs) && (a->outputs == b->outputs) &&
+           (a->requested_rpm == b->requested_rpm) && (a->preselect_rpm == b->preselect_rpm) &&
+           (a->override_permille == b->override_permille) && (a->state == b->state) &&
+           (a->gear == b->gear);
+}
+
+static void print_record(const char *label, const GearboxTraceRecord *record) {
+    printf(
+        "  %-9s cycle %10u  switches %03x  in %x  out %03x  rpm %5u  preselect %5u  "
+        "override %5.3f  gear %3u  %s\n",
+        label, record->cycle, record->inputs & GEARBOX_TRACE_IN_SWITCHES, record->inputs >> 12,
+        record->outputs, record->requested_rpm, record->preselect_rpm,
+        record->override_permille / 1000.0, record->gear, state_name(record->state)
+    );
+}
+
+static void report_divergence(
+    const GearboxTraceRecord *context, unsigned context_count, unsigned long long index,
+    const GearboxTraceRecord *recorded, const GearboxTraceRecord *produced, unsigned long gaps
+) {
+    unsigned bit;
+
+    printf("First divergence at record %llu, cycle %u:\n", index, recorded->cycle);
+    for (bit = 0; bit < context_count; bit++) {
+        print_record("", &context[bit]);
+    }
+    print_record("recorded", recorded);
+    print_record("replayed", produced);
+
+    for (bit = 0; bit < sizeof(OUTPUT_NAMES) / sizeof(OUTPUT_NAMES[0]); bit++) {
+        if (((recorded->outputs ^ produced->outputs) >> bit) & 1) {
+            printf(
+                "  %s: recorded %u, replayed %u\n", OUTPUT_NAMES[bit],
+                (recorded->outputs >> bit) & 1, (produced->outputs >> bit) & 1
+            );
+        }
+    }
+    if (recorded->state != produced->state) {
+        printf(
+            "  state: recorded %s, replayed %s\n", state_name(recorded->state),
+            state_name(produced->state)
+        );
+    }
+    if (recorded->gear != produced->gear) {
+        printf("  gear: recorded %u, replayed %u\n", recorded->gear, produced->gear);
+    }
+    if (gaps > 0) {
+        printf(
+            "  %lu cycles were missing from the trace before, their inputs were assumed to be "
+            "unchanged\n",
+            gaps
+        );
+    }
+}
+
+/* Check the header of a session, the file starts with one and every restart
+ * of mh400e_gearbox_trace appends another one */
+static bool is_header(const unsigned char *bytes) {
+    return (memcmp(bytes, GEARBOX_TRACE_FILE_MAGIC, 4) == 0) &&
+           (bytes[4] == (GEARBOX_TRACE_FILE_VERSION & 0xff)) &&
+           (bytes[5] == (GEARBOX_TRACE_FILE_VERSION >> 8)) &&
+           (bytes[6] == (sizeof(GearboxTraceRecord) & 0xff)) &&
+           (bytes[7] == (sizeof(GearboxTraceRecord) >> 8));
+}
+
+/* Read the next record, skipping session headers. A record is only taken for
+ * a header if its cycle does not continue the previous record. Returns false
+ * at the end of the file. */
+static bool read_record(
+    TraceReader *reader, GearboxTraceRecord *record, bool have_previous, uint32_t next_cycle
+) {
+    unsigned char header[8];
+
+    for (;;) {
+        if (reader->next == reader->count) {
+            reader->offset = ftell(reader->file);
+            reader->count = fread(
+                reader->records, sizeof(GearboxTraceRecord), READ_CHUNK, reader->file
+            );
+            reader->next = 0;
+            if (reader->count == 0) {
+                return false;
+            }
+        }
+
+        memcpy(header, &reader->records[reader->next], sizeof(header));
+        if (!is_header(header) ||
+            (have_previous && (reader->records[reader->next].cycle == next_cycle))) {
+            *record = reader->records[reader->next++];
+            return true;
+        }
+
+        /* Drop the 8 header bytes, the records behind it are shifted by
+         * them. fread() may have consumed a partial record at the end of the
+         * file, so seek to an absolute position. */
+        reader->sessions++;
+        if (fseek(
+                reader->file,
+                reader->offset + (long)(reader->next * sizeof(GearboxTraceRecord)) +
+                    (long)sizeof(header),
+                SEEK_SET
+            ) != 0) {
+            return false;
+        }
+        reader->count = 0;
+        reader->next = 0;
+    }
+}
+
+static double seconds_since(const struct timespec *start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static int usage(void) {
+    fprintf(
+        stderr, "usage: gearbox_replay [--set NAME=VALUE]... [--period-ns NS] [--quiet] TRACE\n"
+    );
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    static TraceReader reader;
+    static Replay replay;
+    GearboxTraceRecord context[CONTEXT_RECORDS];
+    GearboxTraceRecord recorded;
+    unsigned char header[8];
+    const char *path = NULL;
+    long period = 1000000;
+    unsigned long long index = 0;
+    unsigned long gaps = 0;
+    uint32_t next_cycle = 0;
+    struct timespec start;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--period-ns") == 0) && (i + 1 < argc)) {
+            period = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            rtapi_set_msg_level(RTAPI_MSG_NONE);
+        } else if ((strcmp(argv[i], "--set") == 0) && (i + 1 < argc)) {
+            /* params are applied once the component exists */
+            i++;
+        } else if ((argv[i][0] != '-') && (path == NULL)) {
+            path = argv[i];
+        } else {
+            return usage();
+        }
+    }
+    if ((path == NULL) || (period <= 0)) {
+        return usage();
+    }
+
+    reader.file = fopen(path, "rb");
+    if (reader.file == NULL) {
+        fprintf(stderr, "gearbox_replay: can not open %s\n", path);
+        return 2;
+    }
+    /* Traces of another version or record size can not be replayed */
+    if ((fread(header, sizeof(header), 1, reader.file) != 1) || !is_header(header)) {
+        fprintf(
+            stderr, "gearbox_replay: %s is not a version %d trace\n", path,
+            GEARBOX_TRACE_FILE_VERSION
+        );
+        return 2;
+    }
+    rewind(reader.file);
+    if (replay_init(&replay, period) != 0) {
+        fprintf(stderr, "gearbox_replay: can not create the gearbox component\n");
+        return 2;
+    }
+    for (i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--set") == 0) {
+            char *value = strchr(argv[++i], '=');
+
+            if (value != NULL) {
+                *value++ = '\0';
+            }
+            if ((value == NULL) ||
+                (mh400e_gearbox_host_set_param(replay.gearbox, argv[i], atof(value)) != 0)) {
+                fprintf(stderr, "gearbox_replay: unknown param %s\n", argv[i]);
+                return 2;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (read_record(&reader, &recorded, index > 0, next_cycle)) {
+        GearboxTraceRecord produced;
+
+        if (index == 0) {
+            if (recorded.cycle != 0) {
+                printf(
+                    "The trace starts at cycle %u, the gearbox state before is not known\n",
+                    recorded.cycle
+                );
+            }
+        } else if ((int32_t)(recorded.cycle - next_cycle) < 0) {
+            printf(
+                "The gearbox was restarted at record %llu, a new replay is needed from there\n",
+                index
+            );
+            break;
+        } else {
+            /* Records the drainer could not keep up with, keep the inputs */
+            while (recorded.cycle != next_cycle) {
+                replay_cycle(&replay, &context[(index - 1) % CONTEXT_RECORDS]);
+                next_cycle++;
+                gaps++;
+            }
+        }
+
+        produced = replay_cycle(&replay, &recorded);
+        if (!same_behaviour(&recorded, &produced)) {
+            GearboxTraceRecord ordered[CONTEXT_RECORDS];
+            unsigned count = (index < CONTEXT_RECORDS) ? (unsigned)index : CONTEXT_RECORDS;
+            unsigned k;
+
+            for (k = 0; k < count; k++) {
+                ordered[k] = context[(index - count + k) % CONTEXT_RECORDS];
+            }
+            produced.cycle = recorded.cycle;
+            report_divergence(ordered, count, index, &recorded, &produced, gaps);
+            return 1;
+        }
+
+        context[index % CONTEXT_RECORDS] = recorded;
+        next_cycle = recorded.cycle + 1;
+        index++;
+    }
+
+    const double elapsed = seconds_since(&start);
+    printf(
+        "%llu records in %u sessions replayed without divergence, %lu missing cycles\n", index,
+        reader.sessions, gaps
+    );
+    printf(
+        "%.1f s of servo cycles in %.3f s, %.0fx realtime\n", (double)index * period * 1e-9,
+        elapsed, (elapsed > 0) ? (double)index * period * 1e-9 / elapsed : 0.0
+    );
+    fclose(reader.file);
+    return 0;
+}
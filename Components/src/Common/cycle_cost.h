@@ -0,0 +1,62 @@
+/*
+Execution time of a realtime function, measured with rtapi_get_clocks() by the
+components in the servo thread.
+
+Like gearbox_lookup.h this is header only and free of HAL types, the pins are
+created by cycle_cost_hal.h.
+*/
+
+#ifndef CYCLE_COST_H
+#define CYCLE_COST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The mean follows every call with a weight of 1 / (1 << CYCLE_COST_EWMA_SHIFT) */
+#define CYCLE_COST_EWMA_SHIFT 4
+
+/* Cost of the calls of a function in CPU clocks, the unit of
+ * rtapi_get_clocks() and of the time and tmax params of the HAL threads.
+ *
+ * The member names differ from the pin and parameter names of the components,
+ * halcompile turns those into macros. */
+typedef struct {
+    uint32_t latest;
+    uint32_t highest;
+    uint32_t average;
+    uint32_t over_budget_calls;
+    uint64_t average_scaled; /* average << CYCLE_COST_EWMA_SHIFT */
+    bool has_samples;
+} CycleCost;
+
+/* Add the cost of a call. Calls that take longer than budget clocks are
+ * counted, a budget of 0 counts nothing. Costs beyond the range of a u32 pin
+ * are clamped. */
+static inline void cycle_cost_record(CycleCost *cost, long long clocks, uint32_t budget) {
+    uint32_t sample = (uint32_t)clocks;
+
+    if (clocks < 0) {
+        sample = 0;
+    } else if (clocks > (long long)UINT32_MAX) {
+        sample = UINT32_MAX;
+    }
+
+    if (cost->has_samples) {
+        cost->average_scaled -= cost->average_scaled >> CYCLE_COST_EWMA_SHIFT;
+        cost->average_scaled += sample;
+    } else {
+        cost->average_scaled = (uint64_t)sample << CYCLE_COST_EWMA_SHIFT;
+        cost->has_samples = true;
+    }
+
+    cost->latest = sample;
+    cost->average = (uint32_t)(cost->average_scaled >> CYCLE_COST_EWMA_SHIFT);
+    if (sample > cost->highest) {
+        cost->highest = sample;
+    }
+    if ((budget > 0) && (sample > budget) && (cost->over_budget_calls < UINT32_MAX)) {
+        cost->over_budget_calls++;
+    }
+}
+
+#endif // CYCLE_COST_H
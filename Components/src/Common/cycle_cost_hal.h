@@ -0,0 +1,88 @@
+/*
+Cost pins of a component that measures its main function with cycle_cost.h.
+
+The pins only exist when the component was loaded with cycle_cost=1, the
+component calls cycle_cost_export() from its EXTRA_SETUP then. Without them
+the main function skips the measurement, which leaves a single branch on
+cycle_cost_pins.
+
+Unfortunately it is not possible to provide halcompile with multiple sources,
+this header is included by every component that reports its cost.
+*/
+
+#ifndef CYCLE_COST_HAL_H
+#define CYCLE_COST_HAL_H
+
+#include <hal.h>
+#include <rtapi.h>
+
+#include "cycle_cost.h"
+
+typedef struct {
+    hal_u32_t *latest;
+    hal_u32_t *highest;
+    hal_u32_t *average;
+    hal_u32_t *over_budget_calls;
+    hal_bit_t *clear;
+    hal_u32_t budget; /* rw param */
+} CycleCostPins;
+
+/* NULL unless the pins were exported */
+static CycleCostPins *cycle_cost_pins = NULL;
+static CycleCost cycle_cost_data;
+
+/* Create the cost pins <prefix>.cost-last, cost-max, cost-mean,
+ * cost-over-budget, cost-reset and the param <prefix>.cost-budget in clocks.
+ * Returns 0 on success or the error of the HAL function that failed. */
+static int cycle_cost_export(int comp, const char *prefix) {
+    CycleCostPins *pins = hal_malloc(sizeof(CycleCostPins));
+    int result;
+
+    if (pins == NULL) {
+        return -1;
+    }
+
+    result = hal_pin_u32_newf(HAL_OUT, &(pins->latest), comp, "%s.cost-last", prefix);
+    if (result == 0) {
+        result = hal_pin_u32_newf(HAL_OUT, &(pins->highest), comp, "%s.cost-max", prefix);
+    }
+    if (result == 0) {
+        result = hal_pin_u32_newf(HAL_OUT, &(pins->average), comp, "%s.cost-mean", prefix);
+    }
+    if (result == 0) {
+        result = hal_pin_u32_newf(
+            HAL_OUT, &(pins->over_budget_calls), comp, "%s.cost-over-budget", prefix
+        );
+    }
+    if (result == 0) {
+        result = hal_pin_bit_newf(HAL_IN, &(pins->clear), comp, "%s.cost-reset", prefix);
+    }
+    if (result == 0) {
+        result = hal_param_u32_newf(HAL_RW, &(pins->budget), comp, "%s.cost-budget", prefix);
+    }
+    if (result != 0) {
+        return result;
+    }
+
+    pins->budget = 0;
+    cycle_cost_pins = pins;
+    return 0;
+}
+
+/* Record the cost of a call of the main function and publish it. While
+ * cost-reset is set the statistics start over, e.g. to drop the first call
+ * that includes the one time setup of the component. */
+static void cycle_cost_publish(long long clocks) {
+    if (*(cycle_cost_pins->clear)) {
+        cycle_cost_data = (CycleCost){0};
+    }
+
+    cycle_cost_record(&cycle_cost_data, clocks, cycle_cost_pins->budget);
+
+    *(cycle_cost_pins->latest) = cycle_cost_data.latest;
+    *(cycle_cost_pins->highest) = cycle_cost_data.highest;
+    *(cycle_cost_pins->average) = cycle_cost_data.average;
+    *(cycle_cost_pins->over_budget_calls) = cycle_cost_data.over_budget_calls;
+}
+
+#endif // CYCLE_COST_HAL_H
@@ -0,0 +1,104 @@
+/*
+Single producer, single consumer ring of fixed size records in shared memory.
+
+The realtime component is the only producer and never waits: a record that
+does not fit because the consumer fell behind is dropped and counted. A
+userspace process is the only consumer. Neither side takes a lock, the two
+counters are only written by their owner and published with release/acquire
+ordering.
+
+Like gearbox_lookup.h this is header only and free of HAL types, it works on
+any memory both sides can map.
+*/
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_RING_MAGIC 0x5452484du /* "MHRT" */
+
+/* Keep the counters of the producer and the consumer on separate cache lines */
+#define TRACE_RING_CACHE_LINE 64
+
+typedef struct {
+    uint32_t magic;
+    uint32_t record_size; /* bytes */
+    uint32_t capacity;    /* records, a power of two */
+    uint32_t dropped;     /* records that did not fit, written by the producer */
+    uint32_t written __attribute__((aligned(TRACE_RING_CACHE_LINE))); /* by the producer */
+    uint32_t consumed __attribute__((aligned(TRACE_RING_CACHE_LINE))); /* by the consumer */
+    unsigned char records[] __attribute__((aligned(TRACE_RING_CACHE_LINE)));
+} TraceRing;
+
+/* Bytes of shared memory for a ring of capacity records */
+static inline size_t trace_ring_size(uint32_t record_size, uint32_t capacity) {
+    return sizeof(TraceRing) + (size_t)record_size * capacity;
+}
+
+/* Prepare a ring in memory of trace_ring_size() bytes, done by the producer
+ * before the consumer attaches. Returns false unless capacity is a power of
+ * two. */
+static inline bool trace_ring_init(TraceRing *ring, uint32_t record_size, uint32_t capacity) {
+    if ((capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+        return false;
+    }
+    ring->record_size = record_size;
+    ring->capacity = capacity;
+    ring->dropped = 0;
+    ring->written = 0;
+    ring->consumed = 0;
+    __atomic_store_n(&ring->magic, TRACE_RING_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* True once the producer initialized the ring with the expected layout */
+static inline bool trace_ring_valid(const TraceRing *ring, uint32_t record_size) {
+    return (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == TRACE_RING_MAGIC) &&
+           (ring->record_size == record_size);
+}
+
+/* Append a record, called by the producer only. Returns false and counts the
+ * record as dropped if the ring is full. */
+static inline bool trace_ring_push(TraceRing *ring, const void *record) {
+    const uint32_t written = ring->written;
+
+    if (written - __atomic_load_n(&ring->consumed, __ATOMIC_ACQUIRE) >= ring->capacity) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    memcpy(
+        &ring->records[(size_t)(written & (ring->capacity - 1)) * ring->record_size], record,
+        ring->record_size
+    );
+    __atomic_store_n(&ring->written, written + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Copy up to max_records of the oldest records to buffer and release their
+ * slots, called by the consumer only. Returns the number of records copied. */
+static inline uint32_t trace_ring_pop(TraceRing *ring, void *buffer, uint32_t max_records) {
+    const uint32_t consumed = ring->consumed;
+    const uint32_t available = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE) - consumed;
+    const uint32_t count = (available < max_records) ? available : max_records;
+    const uint32_t first = consumed & (ring->capacity - 1);
+    /* The records may wrap around the end of the ring */
+    const uint32_t before_end = (count < ring->capacity - first) ? count : ring->capacity - first;
+
+    memcpy(
+        buffer, &ring->records[(size_t)first * ring->record_size],
+        (size_t)before_end * ring->record_size
+    );
+    memcpy(
+        (unsigned char *)buffer + (size_t)before_end * ring->record_size, ring->records,
+        (size_t)(count - before_end) * ring->record_size
+    );
+    __atomic_store_n(&ring->consumed, consumed + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+#endif // TRACE_RING_H
@@ -86,7 +86,7 @@ typedef struct {
  * RPM.
  *
  * These mappings are used to determine the appropriate settings for various operation modes
- * or conditions based on the RPM or bitmask values.
+ * or conditions based on the RPM or bitmask values. They are generated from gearbox_gears.txt.
  */
 extern SupportedSpeed supported_speeds[];
 
@@ -94,7 +94,7 @@ extern SupportedSpeed supported_speeds[];
  * Represents the total number of supported speed configurations available in the `supported_speeds`
  * array.
  */
-const size_t SUPPORTED_SPEEDS_COUNT;
+extern const size_t SUPPORTED_SPEEDS_COUNT;
 
 /**
  * Retrieves the bitmask value corresponding to a specified revolutions per minute (RPM).
@@ -107,6 +107,8 @@ unsigned get_bitmask_from_rpm(unsigned rpm);
 /**
  * Retrieves the revolutions per minute (RPM) value corresponding to a specified bitmask.
  *
+ * Uses the precomputed bitmask lookup table, so the cost does not depend on the bitmask.
+ *
  * @param bitmask The bitmask used to search for the corresponding RPM value.
  * @return The RPM value corresponding to the given bitmask, or 0 if no match is found.
  */
@@ -134,9 +136,13 @@ bool enable_select_mid_position(TargetAxisMicroSwitchState target_state);
 /**
  * Determine the target gearbox microswitch state for a given spindle speed.
  *
- * Maps the requested RPM to a predefined gearbox state using threshold values.
- * Returns a neutral state if RPM is zero, a fallback state for values above the
- * maximum defined range, and the corresponding state otherwise.
+ * Quantizes the requested RPM with `gearbox_gear_from_rpm()`, the same quantizer that is used by
+ * the mh400e_gearbox component. Returns a neutral state if RPM is zero or negative, the state of
+ * the highest speed for values above the maximum defined range, and the state of the closest
+ * speed otherwise (exact midpoints select the higher speed).
+ *
+ * The states are generated from the same gear definitions (gearbox_gears.txt) as the bitmasks in
+ * `supported_speeds`, for neutral only the reducer matters and the other shafts are centered.
  *
  * The returned state indicates the desired position of the input, center, and
  * reducer gear microswitches to achieve the closest matching gear ratio.
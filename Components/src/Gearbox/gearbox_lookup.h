@@ -0,0 +1,99 @@
+/*
+Gear lookups shared by the gearbox logic and the mh400e_gearbox component.
+
+halcompile can only build a single source file and defines macros for all pin
+names, so everything in here is header only and free of HAL types.
+*/
+
+#ifndef GEARBOX_LOOKUP_H
+#define GEARBOX_LOOKUP_H
+
+#include "gearbox_tables.h"
+
+/* Returned when a bitmask does not describe any gear, which is the case
+ * while a shaft is moving between two positions. */
+#define GEARBOX_GEAR_INVALID 0xff
+
+/* Index of the neutral gear */
+#define GEARBOX_NEUTRAL_GEAR 0
+
+/* Index of the lowest non zero speed */
+#define GEARBOX_MIN_RPM_GEAR 1
+
+/* Number of entries in the rpm decision threshold array */
+#define GEARBOX_RPM_THRESHOLD_COUNT                                                                \
+    (sizeof(GEARBOX_RPM_THRESHOLDS) / sizeof(GEARBOX_RPM_THRESHOLDS[0]))
+
+/* Number of distinct 12 bit microswitch bitmasks. */
+#define GEARBOX_BITMASK_COUNT (sizeof(GEARBOX_GEAR_BY_BITMASK) / sizeof(GEARBOX_GEAR_BY_BITMASK[0]))
+
+/* Return the gear index (position in the supported speeds table, 0 is
+ * neutral) for a 12 bit microswitch bitmask, or GEARBOX_GEAR_INVALID.
+ *
+ * Neutral only depends on the reducer shaft, every bitmask with a centered
+ * reducer has an explicit neutral entry in the table. */
+static inline unsigned gearbox_gear_from_bitmask(unsigned bitmask) {
+    if (bitmask >= GEARBOX_BITMASK_COUNT) {
+        return GEARBOX_GEAR_INVALID;
+    }
+    return GEARBOX_GEAR_BY_BITMASK[bitmask];
+}
+
+/* Quantize a requested spindle speed to the closest supported gear and
+ * return its gear index.
+ *
+ * Everything <= 0 (and NaN) selects neutral. Any other speed selects the
+ * closest non zero speed, so everything below 80 selects 80 and everything
+ * above 4000 selects 4000. Speeds exactly between two gears select the
+ * higher one.
+ *
+ * The doubled speed is compared against the precomputed doubled midpoints,
+ * which makes all thresholds integers. Since the thresholds are integers,
+ * truncating the doubled speed does not change the result of any compare.
+ * The threshold array has a power of two size, so the binary search always
+ * takes the same number of branch free steps. */
+static inline unsigned gearbox_gear_from_rpm(float rpm) {
+    if (!(rpm > 0)) {
+        return GEARBOX_NEUTRAL_GEAR;
+    }
+    if (rpm > GEARBOX_MAX_RPM) {
+        rpm = GEARBOX_MAX_RPM;
+    }
+
+    const unsigned doubled = (unsigned)(2.0f * rpm);
+    unsigned below = 0;
+    for (unsigned step = GEARBOX_RPM_THRESHOLD_COUNT / 2; step > 0; step >>= 1) {
+        below += (GEARBOX_RPM_THRESHOLDS[below + step - 1] <= doubled) ? step : 0;
+    }
+    return GEARBOX_MIN_RPM_GEAR + below;
+}
+
+/* Shaft numbers used in the packed shift orders */
+#define GEARBOX_SHAFT_INPUT 0
+#define GEARBOX_SHAFT_MIDRANGE 1
+#define GEARBOX_SHAFT_REDUCER 2
+#define GEARBOX_SHAFT_COUNT 3
+
+/* Return the planned order in which the shafts should be shifted to get from
+ * one gear to another, use gearbox_shift_order_shaft() to unpack it.
+ *
+ * The plans are generated along with the other tables and minimize the
+ * estimated shift duration, mostly by ordering the shafts so that the shared
+ * reverse and slow relays need to be toggled as rarely as possible and shafts
+ * which need the same relay states follow each other and can move together. If the
+ * current gear is not known (GEARBOX_GEAR_INVALID) the default order input,
+ * midrange, reducer is returned. */
+static inline unsigned gearbox_shift_order(unsigned from_gear, unsigned to_gear) {
+    if ((from_gear >= GEARBOX_GEAR_COUNT) || (to_gear >= GEARBOX_GEAR_COUNT)) {
+        return GEARBOX_DEFAULT_SHIFT_ORDER;
+    }
+    return GEARBOX_SHIFT_ORDER[from_gear][to_gear];
+}
+
+/* Return the shaft that is shifted in the given step (0 is the first one) of
+ * a packed shift order. */
+static inline unsigned gearbox_shift_order_shaft(unsigned order, unsigned step) {
+    return (order >> (2 * step)) & 0x3;
+}
+
+#endif // GEARBOX_LOOKUP_H
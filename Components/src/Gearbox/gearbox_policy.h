@@ -0,0 +1,104 @@
+/*
+Shift policy of the mh400e_gearbox component: decides whether a new spindle
+speed request is worth a full stop, shift and restart cycle or whether the
+gearbox should stay in its current gear.
+
+Like gearbox_lookup.h this is header only and free of HAL types, none of the
+member names may match a pin or parameter name of the component.
+*/
+
+#ifndef GEARBOX_POLICY_H
+#define GEARBOX_POLICY_H
+
+#include "gearbox_lookup.h"
+
+#include <stdbool.h>
+
+/* Programmed speeds closer than this are considered unchanged */
+#define GEARBOX_POLICY_RPM_EPSILON 0.5f
+
+typedef struct {
+    /* Stay in the current gear if the requested speed is within this many
+     * percent of the current gear's speed, 0 disables the band. */
+    float tolerance_percent;
+    /* Only leave the current gear once the requested speed is this many
+     * percent past the point where the quantizer would pick a neighbouring
+     * gear, 0 disables the hysteresis. */
+    float hysteresis_percent;
+    /* Stay in the current gear if only the spindle override changed, but not
+     * the programmed speed. */
+    bool override_lock;
+} GearboxShiftPolicy;
+
+typedef enum {
+    GEARBOX_POLICY_SHIFT,           /* shift to the quantized gear */
+    GEARBOX_POLICY_SAME_GEAR,       /* the request quantizes to the current gear */
+    GEARBOX_POLICY_STAY_TOLERANCE,  /* within the tolerance band */
+    GEARBOX_POLICY_STAY_HYSTERESIS, /* within the hysteresis of a gear boundary */
+    GEARBOX_POLICY_STAY_OVERRIDE    /* only the spindle override changed */
+} GearboxPolicyDecision;
+
+/* Decide what to do with a requested spindle speed.
+ *
+ * current_gear is the index of the engaged gear (GEARBOX_GEAR_INVALID if not
+ * known), requested_rpm the speed including the spindle override, override
+ * the override factor (1 is 100%) and programmed_rpm the speed without
+ * override at the time of the previous decision.
+ *
+ * Requests for neutral are never avoided and nothing is avoided while the
+ * current gear is unknown or neutral. */
+static inline GearboxPolicyDecision gearbox_policy_decide(
+    const GearboxShiftPolicy *policy,
+    unsigned current_gear,
+    float requested_rpm,
+    float override,
+    float programmed_rpm
+) {
+    const unsigned target = gearbox_gear_from_rpm(requested_rpm);
+
+    if (target == current_gear) {
+        return GEARBOX_POLICY_SAME_GEAR;
+    }
+    if ((target == GEARBOX_NEUTRAL_GEAR) || (current_gear == GEARBOX_NEUTRAL_GEAR) ||
+        (current_gear >= GEARBOX_GEAR_COUNT)) {
+        return GEARBOX_POLICY_SHIFT;
+    }
+
+    if (policy->override_lock && (override > 0)) {
+        const float difference = requested_rpm / override - programmed_rpm;
+        if ((difference < GEARBOX_POLICY_RPM_EPSILON) &&
+            (difference > -GEARBOX_POLICY_RPM_EPSILON)) {
+            return GEARBOX_POLICY_STAY_OVERRIDE;
+        }
+    }
+
+    const float current_rpm = GEARBOX_GEAR_RPM[current_gear];
+    const float band = current_rpm * policy->tolerance_percent / 100.0f;
+    if ((requested_rpm >= current_rpm - band) && (requested_rpm <= current_rpm + band)) {
+        return GEARBOX_POLICY_STAY_TOLERANCE;
+    }
+
+    /* Move the boundary towards the neighbouring gear in the direction of the
+     * request outwards. Only a request for the neighbouring gear is held
+     * back, gears are about 1.25x apart and a large hysteresis would swallow
+     * requests for gears further away otherwise. Neutral is never a
+     * neighbour, non zero requests do not quantize to it. */
+    if (policy->hysteresis_percent > 0) {
+        const float factor = policy->hysteresis_percent / 100.0f;
+        if (target == current_gear + 1) {
+            const float boundary = (current_rpm + GEARBOX_GEAR_RPM[current_gear + 1]) / 2.0f;
+            if (requested_rpm < boundary * (1.0f + factor)) {
+                return GEARBOX_POLICY_STAY_HYSTERESIS;
+            }
+        } else if ((target + 1 == current_gear) && (current_gear > GEARBOX_MIN_RPM_GEAR)) {
+            const float boundary = (GEARBOX_GEAR_RPM[current_gear - 1] + current_rpm) / 2.0f;
+            if (requested_rpm > boundary * (1.0f - factor)) {
+                return GEARBOX_POLICY_STAY_HYSTERESIS;
+            }
+        }
+    }
+
+    return GEARBOX_POLICY_SHIFT;
+}
+
+#endif // GEARBOX_POLICY_H
@@ -0,0 +1,58 @@
+/*
+Gear shift telemetry of the mh400e_gearbox component: the fixed buckets of the
+shift time histograms and the index of the per gear pair shift counters.
+
+Like gearbox_lookup.h this is header only and free of HAL types.
+*/
+
+#ifndef GEARBOX_TELEMETRY_H
+#define GEARBOX_TELEMETRY_H
+
+#include "gearbox_lookup.h"
+
+/* Number of buckets of every histogram, the last one counts everything above
+ * the highest bound. The histogram pin arrays of mh400e_gearbox.comp have
+ * this size. */
+#define GEARBOX_HISTOGRAM_BUCKETS 8
+
+/* Upper bounds in milliseconds of the buckets of the total shift time,
+ * including the spin-up of the spindle */
+static const unsigned GEARBOX_SHIFT_TIME_BOUNDS_MS[GEARBOX_HISTOGRAM_BUCKETS - 1] = {
+    500, 1000, 1500, 2000, 2500, 3000, 4000
+};
+
+/* Upper bounds in milliseconds of the buckets of the time a shaft motor ran
+ * during a shift */
+static const unsigned GEARBOX_STAGE_TIME_BOUNDS_MS[GEARBOX_HISTOGRAM_BUCKETS - 1] = {
+    100, 250, 500, 750, 1000, 1500, 2000
+};
+
+/* Number of shift counters, one for every pair of gears */
+#define GEARBOX_PAIR_COUNT (GEARBOX_GEAR_COUNT * GEARBOX_GEAR_COUNT)
+
+/* Returned for pairs without a counter */
+#define GEARBOX_PAIR_INVALID GEARBOX_PAIR_COUNT
+
+/* Return the bucket of a histogram with the given upper bounds for a value.
+ * A value equal to a bound belongs to the bucket of that bound. */
+static inline unsigned gearbox_histogram_bucket(const unsigned *bounds, unsigned value_ms) {
+    unsigned bucket = 0;
+
+    while ((bucket < GEARBOX_HISTOGRAM_BUCKETS - 1) && (value_ms > bounds[bucket])) {
+        bucket++;
+    }
+    return bucket;
+}
+
+/* Return the index of the shift counter for a shift between two gear
+ * indices, or GEARBOX_PAIR_INVALID if the gear at the start of the shift was
+ * not known or the shift did not change the gear. */
+static inline unsigned gearbox_pair_index(unsigned from_gear, unsigned to_gear) {
+    if ((from_gear >= GEARBOX_GEAR_COUNT) || (to_gear >= GEARBOX_GEAR_COUNT) ||
+        (from_gear == to_gear)) {
+        return GEARBOX_PAIR_INVALID;
+    }
+    return from_gear * GEARBOX_GEAR_COUNT + to_gear;
+}
+
+#endif // GEARBOX_TELEMETRY_H
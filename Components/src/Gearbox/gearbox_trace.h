@@ -0,0 +1,70 @@
+/*
+Per cycle trace of the mh400e_gearbox component, written to a trace_ring.h
+ring in RTAPI shared memory and drained to a file by mh400e_gearbox_trace.
+
+Like gearbox_lookup.h this is header only and free of HAL types, the
+producer and the drainer share the record layout and the shared memory key.
+*/
+
+#ifndef GEARBOX_TRACE_H
+#define GEARBOX_TRACE_H
+
+#include <stdint.h>
+
+/* RTAPI shared memory key of the ring */
+#define GEARBOX_TRACE_KEY 0x4d483430 /* "MH40" */
+
+/* Records in the ring, about 4s of the 1kHz servo thread */
+#define GEARBOX_TRACE_DEPTH 4096
+
+/* Trace files start with GEARBOX_TRACE_FILE_MAGIC, the version and the record
+ * size as little endian u16 values, followed by the records */
+#define GEARBOX_TRACE_FILE_MAGIC "MHGT"
+#define GEARBOX_TRACE_FILE_VERSION 2
+
+/* Bits of GearboxTraceRecord.inputs, the microswitches use the bit order of
+ * gearbox_gear_from_bitmask() */
+#define GEARBOX_TRACE_IN_SWITCHES 0x0fffu
+#define GEARBOX_TRACE_IN_SPINDLE_STOPPED (1u << 12)
+#define GEARBOX_TRACE_IN_ESTOP (1u << 13)
+#define GEARBOX_TRACE_IN_TOOL_CHANGE (1u << 14)
+#define GEARBOX_TRACE_IN_SPEED_REACHED (1u << 15)
+
+/* Bits of GearboxTraceRecord.outputs */
+#define GEARBOX_TRACE_OUT_SLOW (1u << 0)
+#define GEARBOX_TRACE_OUT_BACKGEAR (1u << 1)
+#define GEARBOX_TRACE_OUT_MIDRANGE (1u << 2)
+#define GEARBOX_TRACE_OUT_INPUT (1u << 3)
+#define GEARBOX_TRACE_OUT_REVERSE (1u << 4)
+#define GEARBOX_TRACE_OUT_START_SHIFT (1u << 5)
+#define GEARBOX_TRACE_OUT_TWITCH_CW (1u << 6)
+#define GEARBOX_TRACE_OUT_TWITCH_CCW (1u << 7)
+#define GEARBOX_TRACE_OUT_STOP_SPINDLE (1u << 8)
+#define GEARBOX_TRACE_OUT_AT_SPEED (1u << 9)
+#define GEARBOX_TRACE_OUT_ESTOP (1u << 10)
+
+/* State of the gear shift state machine at the end of a cycle */
+typedef enum {
+    GEARBOX_TRACE_IDLE = 0,    /* No shift in progress */
+    GEARBOX_TRACE_SHIFTING,    /* Between two groups of shafts or waiting for a relay */
+    GEARBOX_TRACE_MOVING,      /* A group of shaft motors is running */
+    GEARBOX_TRACE_STOPPING,    /* All shafts reached their target, relays are reset */
+    GEARBOX_TRACE_SPINUP,      /* Waiting for the spindle to turn again */
+    GEARBOX_TRACE_ESTOP        /* estop-in is set */
+} GearboxTraceState;
+
+/* One servo cycle, 16 bytes */
+typedef struct {
+    uint32_t cycle;             /* Calls of the component function, wraps around */
+    uint16_t inputs;            /* GEARBOX_TRACE_IN_* */
+    uint16_t outputs;           /* GEARBOX_TRACE_OUT_* */
+    uint16_t requested_rpm;     /* spindle-speed-in-abs, limited to 65535 */
+    uint16_t preselect_rpm;     /* spindle-speed-preselect, limited to 65535 */
+    uint16_t override_permille; /* spindle-override in 1/1000, limited to 65535 */
+    uint8_t state;              /* GearboxTraceState */
+    uint8_t gear;               /* Index of the current gear or GEARBOX_GEAR_INVALID */
+} GearboxTraceRecord;
+
+_Static_assert(sizeof(GearboxTraceRecord) == 16, "the trace file format needs 16 byte records");
+
+#endif // GEARBOX_TRACE_H
@@ -1,6 +1,8 @@
 #ifndef MH400E_COMMON_H
 #define MH400E_COMMON_H
 
+#include "gearbox_lookup.h"
+
 /* structure that allows to group pins together */
 #define MH400E_PINS_IN_GROUP 4
 typedef struct {
@@ -25,30 +27,6 @@ typedef struct {
 #define MH400E_STAGE_IS_CENTER(mask) ((mask >> 2) & 1)
 #define MH400E_STAGE_IS_LEFT_CENTER(mask) ((mask >> 3) & 1)
 
-/* lookup table from rpm to gearbox status pin values */
-static PairT mh400e_gears[] = {
-    /* rpm   bitmask                msb 11 10 9 8 7 6 5 4 3 2 1 0 lsb */
-    {0, 4},       /* neutral           0 1 0 0 */
-    {80, 1097},   /*   0 1 0 0 0 1 0 0 1 0 0 1 */
-    {100, 2377},  /*   1 0 0 1 0 1 0 0 1 0 0 1 */
-    {125, 585},   /*   1 0 1 0 0 1 0 0 1 0 0 1 */
-    {160, 1177},  /*   0 1 0 0 1 0 0 1 1 0 0 1 */
-    {200, 2457},  /*   1 0 0 1 1 0 0 1 1 0 0 1 */
-    {250, 665},   /*   0 0 1 0 1 0 0 1 1 0 0 1 */
-    {315, 1065},  /*   0 1 0 0 0 0 1 0 1 0 0 1 */
-    {400, 2345},  /*   1 0 0 1 0 0 1 0 1 0 0 1 */
-    {500, 553},   /*   0 0 1 0 0 0 1 0 1 0 0 1 */
-    {630, 1090},  /*   0 1 0 0 0 1 0 0 0 0 1 0 */
-    {800, 2370},  /*   1 0 0 1 0 1 0 0 0 0 1 0 */
-    {1000, 578},  /*   0 0 1 0 0 1 0 0 0 0 1 0 */
-    {1250, 1170}, /*   0 1 0 0 1 0 0 1 0 0 1 0 */
-    {1600, 2450}, /*   1 0 0 1 1 0 0 1 0 0 1 0 */
-    {2000, 658},  /*   0 0 1 0 1 0 0 1 0 0 1 0 */
-    {2500, 1058}, /*   0 1 0 0 0 0 1 0 0 0 1 0 */
-    {3150, 2338}, /*   1 0 0 1 0 0 1 0 0 0 1 0 */
-    {4000, 546}   /*   0 0 1 0 0 0 1 0 0 0 1 0 */
-};
-
 /* Furthest CCW position, marked as "red" on the MAHO   */
 #define MH400E_STAGE_POS_LEFT 9 /* 1001 */
 
@@ -58,7 +36,8 @@ static PairT mh400e_gears[] = {
 /* Furthest CW position, marked as "yellow" on the MAHO */
 #define MH400E_STAGE_POS_RIGHT 2 /* 0010 */
 
-/* total number of selectable gears including neutral */
+/* total number of selectable gears including neutral, mh400e_gears is
+ * defined in mh400e_util.c */
 #define MH400E_NUM_GEARS (sizeof(mh400e_gears) / sizeof(PairT))
 /* max gear index in array */
 #define MH400E_MAX_GEAR_INDEX MH400E_NUM_GEARS - 1
@@ -71,13 +50,28 @@ static PairT mh400e_gears[] = {
 /* max spindle rpm supported by the MH400E */
 #define MH400E_MAX_RPM 4000
 
-#define MH400E_TWITCH_KEEP_PIN_ON 800 * 1000000L  /* 800ms in nanoseconds */
-#define MH400E_TWITCH_KEEP_PIN_OFF 200 * 1000000L /* 200ms in nanoseconds */
+/* The low speed relay is switched 5ms before a shaft motor is energized.
+ * While a motor runs the stage pins are checked on every cycle. */
+#define MH400E_SLOW_MOTOR_INTERVAL 5 * 1000000L /* 5ms in nanoseconds */
+
+/* Initial travel time of a shaft motor per position, the gearbox component
+ * learns the actual times of each shaft, direction and speed while shifting */
+#define MH400E_TRAVEL_PRIOR_FAST 500 * 1000L  /* 500ms in microseconds */
+#define MH400E_TRAVEL_PRIOR_SLOW 1000 * 1000L /* 1s in microseconds */
+
+/* Weight of a new travel time sample is 1/MH400E_TRAVEL_EWMA_WEIGHT */
+#define MH400E_TRAVEL_EWMA_WEIGHT 4
 
-/* When shifting, poll the stage pins each 5ms. Picking a lower value here
- * to make sure that we do not "miss" and do not overshoot our target
- * position. */
-#define MH400E_GEAR_STAGE_POLL_INTERVAL 5 * 1000000L /* 5ms in nanoseconds */
+/* A shaft counts as moving if one of its switches changed within this time,
+ * twitching uses shorter pulses then */
+#define MH400E_TWITCH_PROGRESS_WINDOW 500 * 1000000L /* 500ms in nanoseconds */
+
+/* A shaft whose switches leave the target position within this time after
+ * its motor was switched off overshot the target */
+#define MH400E_OVERSHOOT_WINDOW 100 * 1000000L /* 100ms in nanoseconds */
+
+/* Upper bound of the tracked time since a shaft mask changed */
+#define MH400E_MAX_MASK_AGE 1000 * 1000000L /* 1s in nanoseconds */
 
 /* If reverse direction needs to be activated, we have to wait 100ms before
  * we activate the motor after the reverse pin has been activated or
@@ -87,8 +81,15 @@ static PairT mh400e_gears[] = {
 /* Interval between all remaining pin operations related to gear shifting */
 #define MH400E_GENERIC_PIN_INTERVAL 100 * 1000000L /* 100ms in nanoseconds */
 
-/* TODO: make this a module parameter */
-#define MH400E_WAIT_SPINDLE_AT_SPEED 500 * 1000000L /* 500ms in nanoseconds */
+/* The spindle counts as turning once spindle_stopped stayed low this long */
+#define MH400E_SPINUP_CONFIRM 20 * 1000000L /* 20ms in nanoseconds */
+
+/* Spin-up time of a gear before anything was learned, the fixed wait of
+ * earlier versions */
+#define MH400E_SPINUP_PRIOR 500 * 1000L /* 500ms in microseconds */
+
+/* Weight of a new spin-up time sample is 1/MH400E_SPINUP_EWMA_WEIGHT */
+#define MH400E_SPINUP_EWMA_WEIGHT 4
 /* generic state function */
 typedef void (*statefunc)(long period);
 
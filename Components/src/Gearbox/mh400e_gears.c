@@ -2,6 +2,9 @@
 
 #include "mh400e_gears.h"
 
+#include "gearbox_lookup.h"
+#include "gearbox_telemetry.h"
+#include "gearbox_trace.h"
 #include "mh400e_twitch.h"
 
 #include <stdbool.h>
@@ -22,6 +25,12 @@ typedef struct {
     hal_bit_t *motor_slow;
     unsigned char current_mask; /* auto updated via global variable */
     unsigned char target_mask;
+    long mask_age; /* time since current_mask changed, up to MH400E_MAX_MASK_AGE */
+    long settle_time; /* time since the motor stopped at the target, negative if not watched */
+    long travel[2][2]; /* learned time per position [reverse][slow], microseconds */
+    long run_time;     /* time since the motor was energized, microseconds */
+    int distance;      /* positions to travel, 0 if unknown */
+    long shift_time;   /* time the motor ran during the current shift, microseconds */
 } ShaftDateT;
 
 /* Group all data required for gearshifting */
@@ -31,14 +40,96 @@ static struct {
     hal_bit_t *is_spindle_stopped;
     hal_bit_t *trigger_estop;
     hal_bit_t *notify_spindle_at_speed;
+    hal_bit_t *speed_reached; /* optional at-speed feedback of the spindle drive */
+    hal_bit_t *speed_feedback;
     bool spindle_on_before_shift;
     ShaftDateT backgear;
     ShaftDateT midrange;
     ShaftDateT input_stage;
+    ShaftDateT *plan[GEARBOX_SHAFT_COUNT]; /* order in which shafts are shifted */
+    unsigned plan_step;                    /* index of the first unfinished shaft */
+    unsigned group_end; /* plan index after the running group, 0 if none runs */
+    bool replan;        /* the target changed, plan again once the group ended */
+    PairT *target;
+    hal_bit_t *concurrent; /* move shafts with equal relay states together */
+    hal_u32_t *overshoots;
+    hal_u32_t *restarts;
+    hal_u32_t *eta_ms;
+    hal_float_t *progress;
+    long elapsed; /* time since the shift started, microseconds */
+    long spinup_learned[GEARBOX_GEAR_COUNT]; /* spin-up time per gear, microseconds */
+    long spinup_time;    /* time since the spindle was started again, microseconds */
+    long spinup_confirm; /* time since the spindle is seen rotating, nanoseconds */
+    long spinup_turning; /* spinup_time when the spindle was seen turning, -1 before */
+    bool spinup_failed;  /* the spindle did not reach its speed after the last shift */
+    bool spinup_turned;  /* the spindle turned since the spin-up failed */
+    hal_u32_t *spinup_last;
+    hal_u32_t *spinup_timeouts;
+    hal_u32_t *spinup_margin;
+    hal_u32_t *spinup_timeout;
+    hal_u32_t *spinup_timeout_per_rpm;
+    /* Telemetry of the running shift, published once it finished */
+    bool recording;    /* a shift is running that was not interrupted by an e-stop */
+    unsigned from;     /* gear index at the start of the shift */
+    long shift_time;   /* time since the shift started, microseconds */
+    long wait_time;    /* time spent in gearshift_wait_delay(), microseconds */
+    hal_u32_t restarts_in_shift;
+    hal_u32_t pulses_at_start;
+    hal_u32_t *shifts;
+    hal_u32_t *shift_time_last;
+    hal_u32_t *shift_time_max;
+    hal_u32_t *stage_time_last[GEARBOX_SHAFT_COUNT];
+    hal_u32_t *wait_time_last;
+    hal_u32_t *restarts_last;
+    hal_u32_t *twitch_pulses;
+    hal_u32_t *pulses_last;
+    hal_u32_t *shift_histogram[GEARBOX_HISTOGRAM_BUCKETS];
+    hal_u32_t *stage_histogram[GEARBOX_SHAFT_COUNT][GEARBOX_HISTOGRAM_BUCKETS];
+    hal_u32_t **pair_counts; /* per gearbox_pair_index(), NULL without a pin */
     long delay;
     statefunc next;
 } GGearboxData;
 
+/* Start with the same travel times for every shaft */
+static void gearshift_travel_setup(ShaftDateT *shaft) {
+    shaft->travel[0][0] = MH400E_TRAVEL_PRIOR_FAST;
+    shaft->travel[1][0] = MH400E_TRAVEL_PRIOR_FAST;
+    shaft->travel[0][1] = MH400E_TRAVEL_PRIOR_SLOW;
+    shaft->travel[1][1] = MH400E_TRAVEL_PRIOR_SLOW;
+    shaft->run_time = 0;
+    shaft->distance = 0;
+    shaft->shift_time = 0;
+}
+
+/* Create an output pin for every pair of gears, counting the shifts from one
+ * to the other, e.g. mh400e-gearbox.shifts.630-to-1000. Called from
+ * EXTRA_SETUP, the pins are not declared in the .comp file because halcompile
+ * can not name them after the gears. */
+static int gearshift_export_pair_counts(int comp, const char *prefix) {
+    GGearboxData.pair_counts = hal_malloc(GEARBOX_PAIR_COUNT * sizeof(hal_u32_t *));
+    if (GGearboxData.pair_counts == NULL) {
+        return -1;
+    }
+
+    for (unsigned from = 0; from < GEARBOX_GEAR_COUNT; from++) {
+        for (unsigned to = 0; to < GEARBOX_GEAR_COUNT; to++) {
+            unsigned pair = gearbox_pair_index(from, to);
+            if (pair == GEARBOX_PAIR_INVALID) {
+                continue;
+            }
+            int result = hal_pin_u32_newf(
+                HAL_OUT, &(GGearboxData.pair_counts[pair]), comp, "%s.shifts.%u-to-%u", prefix,
+                mh400e_gears[from].key, mh400e_gears[to].key
+            );
+            if (result != 0) {
+                return result;
+            }
+            *GGearboxData.pair_counts[pair] = 0;
+        }
+    }
+    return 0;
+}
+
 /* One time setup function to prepare data structures related to gearbox
  * switching*/
 FUNCTION(gearbox_setup) {
@@ -66,8 +157,8 @@ FUNCTION(gearbox_setup) {
 #undef reducer_center
 #undef reducer_left_center
     GGearboxData.backgear.status_pins =
-        (PinGroupT){__comp_inst->reducer_left, __comp_inst->reducer_right,
-                    __comp_inst->reducer_center, __comp_inst->reducer_left_center};
+        (PinGroupT){{__comp_inst->reducer_left, __comp_inst->reducer_right,
+                     __comp_inst->reducer_center, __comp_inst->reducer_left_center}};
 #pragma pop_macro("reducer_left")
 #pragma pop_macro("reducer_right")
 #pragma pop_macro("reducer_center")
@@ -76,6 +167,8 @@ FUNCTION(gearbox_setup) {
     GGearboxData.backgear.motor_reverse = &reverse_direction;
     GGearboxData.backgear.motor_slow = &motor_lowspeed;
     GGearboxData.backgear.current_mask = 0;
+    GGearboxData.backgear.mask_age = 0;
+    GGearboxData.backgear.settle_time = -1;
     GGearboxData.backgear.target_mask = mh400e_gears[MH400E_NEUTRAL_GEAR_INDEX].value; /* neutral */
 
     GGearboxData.midrange.state = SHAFT_STATE_OFF;
@@ -88,8 +181,8 @@ FUNCTION(gearbox_setup) {
 #undef middle_center
 #undef middle_left_center
     GGearboxData.midrange.status_pins =
-        (PinGroupT){__comp_inst->middle_left, __comp_inst->middle_right, __comp_inst->middle_center,
-                    __comp_inst->middle_left_center};
+        (PinGroupT){{__comp_inst->middle_left, __comp_inst->middle_right,
+                     __comp_inst->middle_center, __comp_inst->middle_left_center}};
 #pragma pop_macro("middle_left")
 #pragma pop_macro("middle_right")
 #pragma pop_macro("middle_center")
@@ -98,6 +191,8 @@ FUNCTION(gearbox_setup) {
     GGearboxData.midrange.motor_reverse = &reverse_direction;
     GGearboxData.midrange.motor_slow = &motor_lowspeed;
     GGearboxData.midrange.current_mask = 0;
+    GGearboxData.midrange.mask_age = 0;
+    GGearboxData.midrange.settle_time = -1;
     GGearboxData.midrange.target_mask = 0; /* don't care for neutral */
 
     GGearboxData.input_stage.state = SHAFT_STATE_OFF;
@@ -110,8 +205,8 @@ FUNCTION(gearbox_setup) {
 #undef input_center
 #undef input_left_center
     GGearboxData.input_stage.status_pins =
-        (PinGroupT){__comp_inst->input_left, __comp_inst->input_right, __comp_inst->input_center,
-                    __comp_inst->input_left_center};
+        (PinGroupT){{__comp_inst->input_left, __comp_inst->input_right,
+                     __comp_inst->input_center, __comp_inst->input_left_center}};
 #pragma pop_macro("input_left")
 #pragma pop_macro("input_right")
 #pragma pop_macro("input_center")
@@ -120,6 +215,8 @@ FUNCTION(gearbox_setup) {
     GGearboxData.input_stage.motor_reverse = &reverse_direction;
     GGearboxData.input_stage.motor_slow = &motor_lowspeed;
     GGearboxData.input_stage.current_mask = 0;
+    GGearboxData.input_stage.mask_age = 0;
+    GGearboxData.input_stage.settle_time = -1;
     GGearboxData.input_stage.target_mask = 0; /* don't care for neutral */
 
 #pragma push_macro("spindle_stopped")
@@ -131,6 +228,62 @@ FUNCTION(gearbox_setup) {
     GGearboxData.start_shift = &start_gear_shift;
     GGearboxData.trigger_estop = &estop_out;
     GGearboxData.notify_spindle_at_speed = &spindle_at_speed;
+#pragma push_macro("spindle_speed_reached")
+#undef spindle_speed_reached
+    GGearboxData.speed_reached = __comp_inst->spindle_speed_reached;
+#pragma pop_macro("spindle_speed_reached")
+    GGearboxData.speed_feedback = &spinup_feedback;
+    GGearboxData.plan[0] = &(GGearboxData.input_stage);
+    GGearboxData.plan[1] = &(GGearboxData.midrange);
+    GGearboxData.plan[2] = &(GGearboxData.backgear);
+    GGearboxData.plan_step = 0;
+    GGearboxData.group_end = 0;
+    GGearboxData.replan = false;
+    GGearboxData.target = NULL;
+    GGearboxData.concurrent = &concurrent_shift;
+    GGearboxData.overshoots = &overshoot_count;
+    GGearboxData.restarts = &restart_count;
+    GGearboxData.eta_ms = &shift_eta_ms;
+    GGearboxData.progress = &shift_progress;
+    GGearboxData.elapsed = 0;
+    for (unsigned gear = 0; gear < GEARBOX_GEAR_COUNT; gear++) {
+        GGearboxData.spinup_learned[gear] = MH400E_SPINUP_PRIOR;
+    }
+    GGearboxData.spinup_time = 0;
+    GGearboxData.spinup_confirm = 0;
+    GGearboxData.spinup_turning = -1;
+    GGearboxData.spinup_failed = false;
+    GGearboxData.spinup_turned = false;
+    GGearboxData.spinup_last = &spinup_time_ms;
+    GGearboxData.spinup_timeouts = &spinup_timeout_count;
+    GGearboxData.spinup_margin = &spinup_margin_ms;
+    GGearboxData.spinup_timeout = &spinup_timeout_ms;
+    GGearboxData.spinup_timeout_per_rpm = &spinup_timeout_per_1000_rpm_ms;
+    GGearboxData.recording = false;
+    GGearboxData.from = GEARBOX_GEAR_INVALID;
+    GGearboxData.shift_time = 0;
+    GGearboxData.wait_time = 0;
+    GGearboxData.restarts_in_shift = 0;
+    GGearboxData.pulses_at_start = 0;
+    GGearboxData.shifts = &shift_count;
+    GGearboxData.shift_time_last = &shift_time_ms;
+    GGearboxData.shift_time_max = &shift_time_max_ms;
+    GGearboxData.stage_time_last[GEARBOX_SHAFT_INPUT] = &shift_input_ms;
+    GGearboxData.stage_time_last[GEARBOX_SHAFT_MIDRANGE] = &shift_midrange_ms;
+    GGearboxData.stage_time_last[GEARBOX_SHAFT_REDUCER] = &shift_backgear_ms;
+    GGearboxData.wait_time_last = &shift_wait_ms;
+    GGearboxData.restarts_last = &shift_restarts;
+    GGearboxData.twitch_pulses = &twitch_pulse_count;
+    GGearboxData.pulses_last = &shift_twitch_pulses;
+    for (unsigned bucket = 0; bucket < GEARBOX_HISTOGRAM_BUCKETS; bucket++) {
+        GGearboxData.shift_histogram[bucket] = &shift_time_hist(bucket);
+        GGearboxData.stage_histogram[GEARBOX_SHAFT_INPUT][bucket] = &input_time_hist(bucket);
+        GGearboxData.stage_histogram[GEARBOX_SHAFT_MIDRANGE][bucket] = &midrange_time_hist(bucket);
+        GGearboxData.stage_histogram[GEARBOX_SHAFT_REDUCER][bucket] = &backgear_time_hist(bucket);
+    }
+    gearshift_travel_setup(&GGearboxData.backgear);
+    gearshift_travel_setup(&GGearboxData.midrange);
+    gearshift_travel_setup(&GGearboxData.input_stage);
     GGearboxData.delay = 0;
     GGearboxData.next = NULL;
 }
@@ -152,15 +305,38 @@ static unsigned char get_bitmask_from_pingroup(PinGroupT *group) {
     return mask;
 }
 
+/* Latch the mask of one shaft and track how long ago it changed. A shaft
+ * that was stopped at its target is watched for MH400E_OVERSHOOT_WINDOW, if
+ * it coasts past the target meanwhile the overshoot is counted. */
+static void update_shaft_mask(ShaftDateT *shaft, long period) {
+    unsigned char mask = get_bitmask_from_pingroup(&shaft->status_pins);
+
+    if (mask != shaft->current_mask) {
+        shaft->current_mask = mask;
+        shaft->mask_age = 0;
+    } else if (shaft->mask_age < MH400E_MAX_MASK_AGE) {
+        shaft->mask_age = shaft->mask_age + period;
+    }
+
+    if (shaft->settle_time < 0) {
+        return;
+    }
+    if (mask != shaft->target_mask) {
+        *GGearboxData.overshoots = *GGearboxData.overshoots + 1;
+        shaft->settle_time = -1;
+    } else if (shaft->settle_time >= MH400E_OVERSHOOT_WINDOW) {
+        shaft->settle_time = -1;
+    } else {
+        shaft->settle_time = shaft->settle_time + period;
+    }
+}
+
 /* Update current mask values for each shaft */
 // ReSharper disable once CppDeclaratorNeverUsed
-static void update_current_pingroup_masks(void) {
-    GGearboxData.backgear.current_mask =
-        get_bitmask_from_pingroup(&GGearboxData.backgear.status_pins);
-    GGearboxData.midrange.current_mask =
-        get_bitmask_from_pingroup(&GGearboxData.midrange.status_pins);
-    GGearboxData.input_stage.current_mask =
-        get_bitmask_from_pingroup(&GGearboxData.input_stage.status_pins);
+static void update_current_pingroup_masks(long period) {
+    update_shaft_mask(&GGearboxData.backgear, period);
+    update_shaft_mask(&GGearboxData.midrange, period);
+    update_shaft_mask(&GGearboxData.input_stage, period);
 }
 
 static bool estop_on_spindle_running(void) {
@@ -181,32 +357,33 @@ static bool estop_on_spindle_running(void) {
     return false;
 }
 
-/* Combine masks from each pin group to a value representing the current
- * gear setting. A return of NULL means that a corresponding value could
- * not be found, which may indicate a gearshift being in progress- */
-static PairT *get_current_gear(TreeNodeT *tree) {
-    TreeNodeT *result;
-
+/* Index of the current gear in mh400e_gears or GEARBOX_GEAR_INVALID */
+static unsigned get_current_gear_index(void) {
     unsigned combined = (GGearboxData.input_stage.current_mask << 8) |
                         (GGearboxData.midrange.current_mask << 4) |
                         GGearboxData.backgear.current_mask;
 
-    /* special case: ignore all other bits for neutral */
-    if (GGearboxData.backgear.current_mask == mh400e_gears[MH400E_NEUTRAL_GEAR_INDEX].value) {
-        return &(mh400e_gears[MH400E_NEUTRAL_GEAR_INDEX]);
-    }
+    /* The lookup table has explicit entries for neutral, where all bits
+     * except the ones of the backgear are ignored */
+    return gearbox_gear_from_bitmask(combined);
+}
 
-    result = tree_search(tree, combined);
-    if (result != NULL) {
-        return &(mh400e_gears[result->value]);
+/* Combine masks from each pin group to a value representing the current
+ * gear setting. A return of NULL means that a corresponding value could
+ * not be found, which may indicate a gearshift being in progress- */
+static PairT *get_current_gear(void) {
+    unsigned index = get_current_gear_index();
+    if (index == GEARBOX_GEAR_INVALID) {
+        return NULL;
     }
-    return NULL;
+    return &(mh400e_gears[index]);
 }
 
 /* Helper to update delays, returns true if time has not elapsed. */
 static bool gearshift_wait_delay(long period) {
     if ((period > 0) && (GGearboxData.delay > 0)) {
         GGearboxData.delay = GGearboxData.delay - period;
+        GGearboxData.wait_time = GGearboxData.wait_time + period / 1000;
         return true;
     }
     GGearboxData.delay = 0;
@@ -287,112 +464,204 @@ static bool gearshift_protect(ShaftDateT *shaft) {
     return true;
 }
 
-/* Generic function that has the exact same logic, valid for all of the
- * three shafts. */
-static void gearshift_stage(ShaftDateT *shaft, statefunc me, statefunc next, long period) {
-    if (estop_on_spindle_running()) {
+/* Returns true if the shaft does not need to move (anymore). Shafts that do
+ * not matter for the target gear (neutral) have an empty target mask. */
+static bool gearshift_shaft_done(ShaftDateT *shaft) {
+    return (shaft->target_mask == 0) || (shaft->current_mask == shaft->target_mask);
+}
+
+/* Going to the center requres lowering the motor speed */
+static bool gearshift_need_slow(ShaftDateT *shaft) {
+    return MH400E_STAGE_IS_CENTER(shaft->target_mask);
+}
+
+/* Position of a shaft from left (0) to right (2), -1 while it is between two
+ * positions */
+static int gearshift_position(unsigned char mask) {
+    switch (mask) {
+    case MH400E_STAGE_POS_LEFT:
+        return 0;
+    case MH400E_STAGE_POS_CENTER:
+        return 1;
+    case MH400E_STAGE_POS_RIGHT:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+/* Number of positions a shaft has to travel to its target, 0 if unknown */
+static int gearshift_distance(ShaftDateT *shaft) {
+    int from = gearshift_position(shaft->current_mask);
+    int to = gearshift_position(shaft->target_mask);
+
+    if ((from < 0) || (to < 0)) {
+        return 0;
+    }
+    return (from > to) ? (from - to) : (to - from);
+}
+
+/* Expected travel time of a shaft that still has to move, unknown distances
+ * are estimated as one position */
+static long gearshift_expected_travel(ShaftDateT *shaft, bool reverse, bool slow) {
+    int distance = gearshift_distance(shaft);
+    return ((distance > 0) ? distance : 1) * shaft->travel[reverse][slow];
+}
+
+/* Update the travel time model of a shaft that reached its target with an
+ * exponentially weighted moving average of the time per position. Moves
+ * which started between two positions or were restarted are not used. */
+static void gearshift_learn_travel(ShaftDateT *shaft) {
+    if (shaft->distance <= 0) {
         return;
     }
 
-    if (gearshift_wait_delay(period)) {
-        GGearboxData.next = me;
+    long *travel = &(shaft->travel[*shaft->motor_reverse ? 1 : 0][*shaft->motor_slow ? 1 : 0]);
+    long sample = shaft->run_time / shaft->distance;
+    *travel = *travel + (sample - *travel) / MH400E_TRAVEL_EWMA_WEIGHT;
+}
+
+static void gearshift_stop(long period);
+static void gearshift_spinup(long period);
+static void gearshift_finished(void);
+static ShaftDateT *gearshift_shaft(unsigned shaft);
+static void gearshift_plan(PairT *target_gear);
+
+/* Start the next group of shafts of the plan.
+ *
+ * A group is the next shaft of the plan that still needs to move, together
+ * with all directly following shafts that need the same direction and speed.
+ * With concurrent shifting disabled a group is always a single shaft.
+ *
+ * The reverse and slow relays are shared by all shaft motors, they are not
+ * reset after a group finished but only toggled when the next group needs
+ * them in a different state, gearshift_stop() turns them off at the end of
+ * the shift. This is what makes the order of the shafts matter. */
+static void gearshift_group_start(long period) {
+    while ((GGearboxData.plan_step < GEARBOX_SHAFT_COUNT) &&
+           gearshift_shaft_done(GGearboxData.plan[GGearboxData.plan_step])) {
+        GGearboxData.plan_step++;
+    }
+
+    if (GGearboxData.plan_step >= GEARBOX_SHAFT_COUNT) {
+        GGearboxData.next = gearshift_stop;
         return;
     }
 
-    if (shaft->state == SHAFT_STATE_OFF) {
+    ShaftDateT *first = GGearboxData.plan[GGearboxData.plan_step];
+    bool reverse = gearshift_need_reverse(first->target_mask, first->current_mask);
+    bool slow = gearshift_need_slow(first);
 
-        /* Are the pins already in the desired state? */
-        if (shaft->current_mask == shaft->target_mask) {
-            GGearboxData.next = next;
-        } else {
-            shaft->state = SHAFT_STATE_ON;
+    /* Relays are only toggled while all motors are off */
+    if (*first->motor_reverse != reverse) {
+        *first->motor_reverse = reverse;
+        GGearboxData.delay = MH400E_REVERSE_MOTOR_INTERVAL;
+        return;
+    }
 
-            if (gearshift_need_reverse(shaft->target_mask, shaft->current_mask)) {
-                *shaft->motor_reverse = true;
-                GGearboxData.delay = MH400E_REVERSE_MOTOR_INTERVAL;
-            }
-            GGearboxData.next = me;
+    if (*first->motor_slow != slow) {
+        *first->motor_slow = slow;
+        GGearboxData.delay = MH400E_SLOW_MOTOR_INTERVAL;
+        return;
+    }
+
+    unsigned step;
+    for (step = GGearboxData.plan_step; step < GEARBOX_SHAFT_COUNT; step++) {
+        ShaftDateT *shaft = GGearboxData.plan[step];
+        if (gearshift_shaft_done(shaft)) {
+            continue;
         }
-    } else if (shaft->state == SHAFT_STATE_ON) {
-        /* Did we reach the desired position? */
-        if (shaft->current_mask == shaft->target_mask) {
-            if (*shaft->motor_on) {
-                /* De-energize the shaft motor */
-                *shaft->motor_on = false;
-            } else {
-                /* Second time we enter this state the motor will be off,
-                 * that means that we already did the waiting that may have
-                 * been set in the "if" below. If reverse direction was
-                 * not active originally, then this does nothing */
-                *shaft->motor_reverse = false;
-            }
 
-            /* If reverse direction has been set, disable it in 100ms */
-            if (*shaft->motor_reverse) {
-                GGearboxData.delay = MH400E_GENERIC_PIN_INTERVAL;
-                GGearboxData.next = me;
-                return;
-            } else {
-                *shaft->motor_slow = false;
-            }
+        if ((shaft != first) &&
+            (!*GGearboxData.concurrent ||
+             (gearshift_need_reverse(shaft->target_mask, shaft->current_mask) != reverse) ||
+             (gearshift_need_slow(shaft) != slow))) {
+            break;
+        }
 
-            if (*shaft->motor_slow) {
-                GGearboxData.delay = MH400E_GENERIC_PIN_INTERVAL;
-                GGearboxData.next = me;
-                return;
-            }
+        /* Energize the shaft motor */
+        *shaft->motor_on = true;
+        shaft->state = SHAFT_STATE_ON;
+        shaft->settle_time = -1;
+        shaft->run_time = 0;
+        shaft->distance = gearshift_distance(shaft);
+        GGearboxData.group_end = step + 1;
+    }
 
-            /* We are done here, proceed to the next stage */
-            shaft->state = SHAFT_STATE_OFF;
-            GGearboxData.delay = MH400E_GENERIC_PIN_INTERVAL;
-            GGearboxData.next = next;
-        } else {
-            /* Protect furthest lect/CW and right/CCW end positions by not
-             * allowing the motor to continue running if we reached them,
-             * this should never happen, but it's better to have a safety
-             * measure to prevent hardware damage. The function will
-             * immediately stop the motor and trigger an emergency stop if this
-             * error condition is detected. */
-            if (gearshift_protect(shaft)) {
-                *shaft->motor_on = false;
-                shaft->state = SHAFT_STATE_RESTART;
-                GGearboxData.delay = MH400E_REVERSE_MOTOR_INTERVAL;
-                GGearboxData.next = me;
-                return;
-            }
+    /* Twitching helps the gears to mesh while the shafts move */
+    twitch_progress(false);
+    twitch_start(period);
+}
 
-            /* Going to the center requres lowering the motor speed */
-            if (MH400E_STAGE_IS_CENTER(shaft->target_mask) && !(*shaft->motor_slow)) {
-                *shaft->motor_slow = true;
-            } else if (!(*shaft->motor_on)) {
-                /* Energize motor if it is not yet running */
-                *shaft->motor_on = true;
-            }
+/* Check all shafts of the running group on every cycle, the masks are latched
+ * right before this by update_current_pingroup_masks(), so each motor is
+ * stopped in the same cycle in which its target position shows up. The group
+ * is finished when all motors are off. */
+static void gearshift_group_poll(long period) {
+    bool running = false;
+    bool progressing = false;
+    bool restart = false;
+    unsigned step;
 
-            GGearboxData.delay = MH400E_GEAR_STAGE_POLL_INTERVAL;
-            GGearboxData.next = me;
+    for (step = GGearboxData.plan_step; step < GGearboxData.group_end; step++) {
+        ShaftDateT *shaft = GGearboxData.plan[step];
+        if (shaft->state != SHAFT_STATE_ON) {
+            restart = restart || (shaft->state == SHAFT_STATE_RESTART);
+            continue;
         }
-    } else if (shaft->state == SHAFT_STATE_RESTART) {
-        /* Protection function restarted us, motor is already off and
-         * we came here after a certain delay. We now need to check what to do
-         * and re-energize */
-        if (*shaft->motor_reverse) {
-            *shaft->motor_reverse = false;
-            GGearboxData.delay = MH400E_GENERIC_PIN_INTERVAL;
-            GGearboxData.next = me;
-            return;
+
+        shaft->run_time = shaft->run_time + period / 1000;
+        shaft->shift_time = shaft->shift_time + period / 1000;
+
+        /* Did we reach the desired position? */
+        if (shaft->current_mask == shaft->target_mask) {
+            *shaft->motor_on = false;
+            shaft->state = SHAFT_STATE_OFF;
+            shaft->settle_time = 0;
+            gearshift_learn_travel(shaft);
+            continue;
         }
 
-        if (*shaft->motor_slow) {
-            *shaft->motor_slow = false;
-            GGearboxData.delay = MH400E_GENERIC_PIN_INTERVAL;
+        /* Protect furthest lect/CW and right/CCW end positions by not
+         * allowing the motor to continue running if we reached them,
+         * this should never happen, but it's better to have a safety
+         * measure to prevent hardware damage. The function will
+         * immediately stop the motor and trigger an emergency stop if this
+         * error condition is detected. */
+        if (gearshift_protect(shaft)) {
+            *shaft->motor_on = false;
+            shaft->state = SHAFT_STATE_RESTART;
+            *GGearboxData.restarts = *GGearboxData.restarts + 1;
+            GGearboxData.restarts_in_shift++;
+            restart = true;
+            continue;
         }
 
-        /* Going back to the OFF state will retrigger the shift logic for
-         * this shaft */
-        shaft->state = SHAFT_STATE_OFF;
-        GGearboxData.next = me;
+        running = true;
+        progressing = progressing || (shaft->mask_age < MH400E_TWITCH_PROGRESS_WINDOW);
+    }
+
+    if (running) {
+        twitch_progress(progressing);
+        return;
+    }
+
+    /* No need to twitch until the next group starts */
+    twitch_stop(period);
+
+    /* All motors of the group are off. Shafts which missed their target
+     * are picked up again by the next group, which sets the relays for the
+     * direction towards their target. Leave some time before the relays or
+     * the next motors are switched. */
+    for (step = GGearboxData.plan_step; step < GGearboxData.group_end; step++) {
+        GGearboxData.plan[step]->state = SHAFT_STATE_OFF;
     }
+    GGearboxData.group_end = 0;
+    if (GGearboxData.replan) {
+        gearshift_plan(GGearboxData.target);
+    }
+    GGearboxData.delay =
+        restart ? MH400E_REVERSE_MOTOR_INTERVAL : MH400E_GENERIC_PIN_INTERVAL;
 }
 
 static void gearshift_stop(long period) {
@@ -401,10 +670,19 @@ static void gearshift_stop(long period) {
         return;
     }
 
+    /* The shared relays are left on between the shafts, all motors are off
+     * at this point. */
+    if (*GGearboxData.backgear.motor_reverse || *GGearboxData.backgear.motor_slow) {
+        *GGearboxData.backgear.motor_reverse = false;
+        *GGearboxData.backgear.motor_slow = false;
+        GGearboxData.delay = MH400E_GENERIC_PIN_INTERVAL;
+        GGearboxData.next = gearshift_stop;
+        return;
+    }
+
     twitch_stop(period);
 
     if (!twitch_stop_completed()) {
-        GGearboxData.delay = MH400E_TWITCH_KEEP_PIN_OFF;
         GGearboxData.next = gearshift_stop;
         return;
     }
@@ -414,31 +692,266 @@ static void gearshift_stop(long period) {
 
         if (GGearboxData.spindle_on_before_shift) {
             *GGearboxData.do_stop_spindle = false;
-            GGearboxData.delay = MH400E_WAIT_SPINDLE_AT_SPEED;
-            GGearboxData.next = gearshift_stop;
+            GGearboxData.spinup_time = 0;
+            GGearboxData.spinup_confirm = 0;
+            GGearboxData.spinup_turning = -1;
+            GGearboxData.next = gearshift_spinup;
             return;
         }
     }
 
-    if (GGearboxData.spindle_on_before_shift) {
+    /* We are done shifting, reset everything */
+    gearshift_finished();
+}
+
+/* Learned spin-up time of the target gear, microseconds */
+static long *gearshift_spinup_learned(void) {
+    return &(GGearboxData.spinup_learned[GGearboxData.target - mh400e_gears]);
+}
+
+/* Longest time the spindle of the target gear may need to spin up,
+ * microseconds */
+static long gearshift_spinup_limit(void) {
+    long rpm = GEARBOX_GEAR_RPM[GGearboxData.target - mh400e_gears];
+
+    return (*GGearboxData.spinup_timeout + rpm * *GGearboxData.spinup_timeout_per_rpm / 1000) *
+           1000L;
+}
+
+/* Wait for the spindle to reach its speed again after the shift.
+ *
+ * The spindle turns once spindle_stopped stayed low for MH400E_SPINUP_CONFIRM.
+ * Turning does not mean that it is at speed yet:
+ * - with spinup_feedback set, spindle_speed_reached of the spindle drive
+ *   confirms the speed,
+ * - without feedback the spindle is at speed spinup_margin_ms after it was
+ *   seen turning.
+ * The time it took is learned per gear for the shift ETA.
+ *
+ * The spin-up fails if the spindle still stands, or the drive did not confirm
+ * the speed, once gearshift_spinup_limit() passed. A spindle that turns keeps
+ * waiting for its confirmation or the margin. After a failure spindle-at-speed
+ * stays off until the spindle turned and was stopped again or the next shift
+ * starts. */
+static void gearshift_spinup(long period) {
+    long *learned = gearshift_spinup_learned();
+    bool reached;
+    bool failed;
+
+    GGearboxData.spinup_time = GGearboxData.spinup_time + period / 1000;
+
+    if (*GGearboxData.is_spindle_stopped) {
+        GGearboxData.spinup_confirm = 0;
+        GGearboxData.spinup_turning = -1;
+    } else {
+        GGearboxData.spinup_confirm = GGearboxData.spinup_confirm + period;
+        if ((GGearboxData.spinup_turning < 0) &&
+            (GGearboxData.spinup_confirm >= MH400E_SPINUP_CONFIRM)) {
+            GGearboxData.spinup_turning = GGearboxData.spinup_time;
+        }
+    }
+
+    if (*GGearboxData.speed_feedback) {
+        reached = (GGearboxData.spinup_turning >= 0) && *GGearboxData.speed_reached;
+        failed = !*GGearboxData.speed_reached;
+    } else {
+        reached = (GGearboxData.spinup_turning >= 0) &&
+                  (GGearboxData.spinup_time >=
+                   GGearboxData.spinup_turning + *GGearboxData.spinup_margin * 1000L);
+        failed = *GGearboxData.is_spindle_stopped;
+    }
+    failed = failed && (GGearboxData.spinup_time >= gearshift_spinup_limit());
+
+    if (reached) {
+        *GGearboxData.spinup_last = (hal_u32_t)(GGearboxData.spinup_time / 1000);
+        *learned = *learned + (GGearboxData.spinup_time - *learned) / MH400E_SPINUP_EWMA_WEIGHT;
         *GGearboxData.notify_spindle_at_speed = true;
+    } else if (failed) {
+        rtapi_print_msg(
+            RTAPI_MSG_ERR, "mh400e_gearbox: WARNING: spindle did not reach its speed after "
+                           "the shift!\n"
+        );
+        *GGearboxData.spinup_timeouts = *GGearboxData.spinup_timeouts + 1;
+        GGearboxData.spinup_failed = true;
+        GGearboxData.spinup_turned = false;
+    } else {
+        return;
+    }
+
+    gearshift_finished();
+}
+
+/* Publish the telemetry of a shift that ran to its end */
+static void gearshift_record_telemetry(void) {
+    hal_u32_t time_ms = (hal_u32_t)(GGearboxData.shift_time / 1000);
+    unsigned pair = gearbox_pair_index(GGearboxData.from, GGearboxData.target - mh400e_gears);
+    unsigned bucket;
+    unsigned shaft;
+
+    *GGearboxData.shifts = *GGearboxData.shifts + 1;
+    *GGearboxData.shift_time_last = time_ms;
+    if (time_ms > *GGearboxData.shift_time_max) {
+        *GGearboxData.shift_time_max = time_ms;
+    }
+    bucket = gearbox_histogram_bucket(GEARBOX_SHIFT_TIME_BOUNDS_MS, time_ms);
+    (*GGearboxData.shift_histogram[bucket])++;
+
+    for (shaft = 0; shaft < GEARBOX_SHAFT_COUNT; shaft++) {
+        long stage_time = gearshift_shaft(shaft)->shift_time;
+        hal_u32_t stage_ms = (hal_u32_t)(stage_time / 1000);
+
+        *GGearboxData.stage_time_last[shaft] = stage_ms;
+        /* Only shafts that moved count in the histograms */
+        if (stage_time > 0) {
+            bucket = gearbox_histogram_bucket(GEARBOX_STAGE_TIME_BOUNDS_MS, stage_ms);
+            (*GGearboxData.stage_histogram[shaft][bucket])++;
+        }
+    }
+
+    *GGearboxData.wait_time_last = (hal_u32_t)(GGearboxData.wait_time / 1000);
+    *GGearboxData.restarts_last = GGearboxData.restarts_in_shift;
+    *GGearboxData.pulses_last = *GGearboxData.twitch_pulses - GGearboxData.pulses_at_start;
+
+    if ((pair != GEARBOX_PAIR_INVALID) && (GGearboxData.pair_counts != NULL)) {
+        *GGearboxData.pair_counts[pair] = *GGearboxData.pair_counts[pair] + 1;
+    }
+}
+
+/* The shift ended, publish its telemetry unless an e-stop interrupted it */
+static void gearshift_finished(void) {
+    if (GGearboxData.recording) {
+        gearshift_record_telemetry();
+        GGearboxData.recording = false;
     }
 
-    /* We are done shifting, reset everything */
     GGearboxData.next = NULL;
     GGearboxData.spindle_on_before_shift = false;
 }
 
-static void gearshift_backgear(long period) {
-    gearshift_stage(&(GGearboxData.backgear), gearshift_backgear, gearshift_stop, period);
+/* Shift the shafts following the plan, one group of shafts at a time */
+static void gearshift_shafts(long period) {
+    if (estop_on_spindle_running()) {
+        return;
+    }
+
+    if (gearshift_wait_delay(period)) {
+        return;
+    }
+
+    if (GGearboxData.group_end == 0) {
+        gearshift_group_start(period);
+    } else {
+        gearshift_group_poll(period);
+    }
+}
+
+/* Map a shaft number of a packed shift order to its data */
+static ShaftDateT *gearshift_shaft(unsigned shaft) {
+    switch (shaft) {
+    case GEARBOX_SHAFT_INPUT:
+        return &(GGearboxData.input_stage);
+    case GEARBOX_SHAFT_MIDRANGE:
+        return &(GGearboxData.midrange);
+    default:
+        return &(GGearboxData.backgear);
+    }
+}
+
+/* Plan the order of the shafts for a shift from the current to the target
+ * gear, see gearbox_shift_order(). */
+static void gearshift_plan(PairT *target_gear) {
+    unsigned order = gearbox_shift_order(
+        get_current_gear_index(), (unsigned)(target_gear - mh400e_gears)
+    );
+    unsigned step;
+    for (step = 0; step < GEARBOX_SHAFT_COUNT; step++) {
+        GGearboxData.plan[step] = gearshift_shaft(gearbox_shift_order_shaft(order, step));
+    }
+    GGearboxData.plan_step = 0;
+    GGearboxData.group_end = 0;
+    GGearboxData.replan = false;
 }
 
-static void gearshift_midrange(long period) {
-    gearshift_stage(&(GGearboxData.midrange), gearshift_midrange, gearshift_backgear, period);
+/* Estimate the remaining time of the running shift in microseconds.
+ *
+ * Follows the same rules as the state machine: the remaining plan is walked
+ * in groups of shafts which need the same relay states, relay toggles and
+ * pauses between groups are added, a group takes as long as its slowest
+ * shaft according to the learned travel times. */
+static long gearshift_remaining(void) {
+    long remaining = GGearboxData.delay / 1000;
+    bool reverse = *GGearboxData.backgear.motor_reverse;
+    bool slow = *GGearboxData.backgear.motor_slow;
+    long group = -1;       /* remaining time of the current group, -1 if none */
+    bool joinable = false; /* the current group has not started moving yet */
+    unsigned step;
+
+    for (step = GGearboxData.plan_step; step < GEARBOX_SHAFT_COUNT; step++) {
+        ShaftDateT *shaft = GGearboxData.plan[step];
+        long travel;
+
+        if (shaft->state == SHAFT_STATE_ON) {
+            /* Running shafts belong to the group that is already moving */
+            travel = ((shaft->distance > 0) ? shaft->distance : 1) * shaft->travel[reverse][slow] -
+                     shaft->run_time;
+            travel = (travel > 0) ? travel : 0;
+            group = (travel > group) ? travel : group;
+            continue;
+        }
+
+        if (gearshift_shaft_done(shaft)) {
+            continue;
+        }
+
+        bool need_reverse = gearshift_need_reverse(shaft->target_mask, shaft->current_mask);
+        bool need_slow = gearshift_need_slow(shaft);
+        travel = gearshift_expected_travel(shaft, need_reverse, need_slow);
+
+        if (joinable && *GGearboxData.concurrent && (reverse == need_reverse) &&
+            (slow == need_slow)) {
+            group = (travel > group) ? travel : group;
+            continue;
+        }
+
+        if (group >= 0) {
+            remaining = remaining + group + MH400E_GENERIC_PIN_INTERVAL / 1000;
+        }
+        if (reverse != need_reverse) {
+            reverse = need_reverse;
+            remaining = remaining + MH400E_REVERSE_MOTOR_INTERVAL / 1000;
+        }
+        if (slow != need_slow) {
+            slow = need_slow;
+            remaining = remaining + MH400E_SLOW_MOTOR_INTERVAL / 1000;
+        }
+        group = travel;
+        joinable = true;
+    }
+
+    if (group >= 0) {
+        remaining = remaining + group + MH400E_GENERIC_PIN_INTERVAL / 1000;
+    }
+    if (reverse || slow) {
+        remaining = remaining + MH400E_GENERIC_PIN_INTERVAL / 1000;
+    }
+    if (GGearboxData.next == gearshift_spinup) {
+        remaining = *gearshift_spinup_learned() - GGearboxData.spinup_time;
+        remaining = (remaining > 0) ? remaining : 0;
+    } else if (GGearboxData.spindle_on_before_shift) {
+        remaining = remaining + *gearshift_spinup_learned();
+    }
+
+    return remaining;
 }
 
-static void gearshift_input_stage(long period) {
-    gearshift_stage(&(GGearboxData.input_stage), gearshift_input_stage, gearshift_midrange, period);
+/* Update the shift-eta-ms and shift-progress pins */
+static void gearshift_update_eta(long period) {
+    long remaining = gearshift_remaining();
+
+    GGearboxData.elapsed = GGearboxData.elapsed + period / 1000;
+    *GGearboxData.eta_ms = (hal_u32_t)(remaining / 1000);
+    *GGearboxData.progress =
+        (hal_float_t)GGearboxData.elapsed / (hal_float_t)(GGearboxData.elapsed + remaining);
 }
 
 /* Call this function once per each thread cycle to handle gearshifting,
@@ -456,7 +969,32 @@ static void gearshift_handle(long period) {
         return;
     }
 
+    GGearboxData.shift_time = GGearboxData.shift_time + period / 1000;
     GGearboxData.next(period);
+
+    if (gearshift_in_progress()) {
+        gearshift_update_eta(period);
+    } else {
+        *GGearboxData.eta_ms = 0;
+        *GGearboxData.progress = 1;
+    }
+}
+
+/* Set the target mask of one shaft, a shaft that leaves a previous target
+ * does not overshoot it */
+static void gearshift_set_shaft_target(ShaftDateT *shaft, unsigned char mask) {
+    if (mask != shaft->target_mask) {
+        shaft->settle_time = -1;
+    }
+    shaft->target_mask = mask;
+}
+
+/* Set the target masks of all shafts */
+static void gearshift_set_target(PairT *target_gear) {
+    gearshift_set_shaft_target(&GGearboxData.backgear, (target_gear->value) & 0x000f);
+    gearshift_set_shaft_target(&GGearboxData.midrange, (target_gear->value & 0x00f0) >> 4);
+    gearshift_set_shaft_target(&GGearboxData.input_stage, (target_gear->value & 0x0f00) >> 8);
+    GGearboxData.target = target_gear;
 }
 
 /* Start shifting process */
@@ -465,9 +1003,19 @@ static void gearshift_start(PairT *target_gear, long period) {
         return;
     }
 
-    GGearboxData.backgear.target_mask = (target_gear->value) & 0x000f;
-    GGearboxData.midrange.target_mask = (target_gear->value & 0x00f0) >> 4;
-    GGearboxData.input_stage.target_mask = (target_gear->value & 0x0f00) >> 8;
+    gearshift_set_target(target_gear);
+    GGearboxData.spinup_failed = false;
+
+    /* Start the telemetry of this shift */
+    GGearboxData.recording = true;
+    GGearboxData.from = get_current_gear_index();
+    GGearboxData.shift_time = 0;
+    GGearboxData.wait_time = 0;
+    GGearboxData.restarts_in_shift = 0;
+    GGearboxData.pulses_at_start = *GGearboxData.twitch_pulses;
+    GGearboxData.input_stage.shift_time = 0;
+    GGearboxData.midrange.shift_time = 0;
+    GGearboxData.backgear.shift_time = 0;
 
     /* Make sure to leave 100ms between setting start_gear_shift to "on"
      * and further operations */
@@ -475,15 +1023,75 @@ static void gearshift_start(PairT *target_gear, long period) {
 
     *GGearboxData.start_shift = true;
 
-    twitch_start(period);
+    /* Shafts which do not matter for the target gear (only the backgear
+     * matters for neutral) have an empty target mask and are skipped */
+    gearshift_plan(target_gear);
+    GGearboxData.next = gearshift_shafts;
+
+    GGearboxData.elapsed = 0;
+    gearshift_update_eta(0);
+}
+
+/* Change the target gear of a running shift.
+ *
+ * Running shaft motors keep going if they still move towards the new target
+ * with the same relay states, otherwise they are switched off. Like after a
+ * restart the group then ends with a pause long enough to reverse the motor
+ * and the remaining shafts are planned again from their current positions,
+ * shafts which are already where the new target needs them are skipped. */
+static bool gearshift_retarget(PairT *target_gear, long period) {
+    if (!gearshift_in_progress()) {
+        gearshift_start(target_gear, period);
+        return true;
+    }
+
+    /* The spindle is already started again, let the shift finish */
+    if (!*GGearboxData.start_shift) {
+        return false;
+    }
+
+    if (target_gear == GGearboxData.target) {
+        return true;
+    }
+
+    if (estop_on_spindle_running()) {
+        return true;
+    }
+
+    gearshift_set_target(target_gear);
+
+    unsigned step;
+    for (step = GGearboxData.plan_step; step < GGearboxData.group_end; step++) {
+        ShaftDateT *shaft = GGearboxData.plan[step];
+        if (shaft->state != SHAFT_STATE_ON) {
+            continue;
+        }
+
+        /* The travel time is not learned from a move with two targets */
+        shaft->distance = 0;
 
-    /* Special case: if we want to go to the neutral position, we
-     * only care about the backgear stage, so we can jump right to it */
-    if (GGearboxData.backgear.target_mask == mh400e_gears[MH400E_NEUTRAL_GEAR_INDEX].value) {
-        GGearboxData.next = gearshift_backgear;
+        if (gearshift_shaft_done(shaft)) {
+            *shaft->motor_on = false;
+            shaft->state = SHAFT_STATE_OFF;
+        } else if ((gearshift_need_reverse(shaft->target_mask, shaft->current_mask) !=
+                    *shaft->motor_reverse) ||
+                   (gearshift_need_slow(shaft) != *shaft->motor_slow)) {
+            *shaft->motor_on = false;
+            shaft->state = SHAFT_STATE_RESTART;
+            GGearboxData.restarts_in_shift++;
+        }
+    }
+
+    if (GGearboxData.group_end == 0) {
+        gearshift_plan(target_gear);
     } else {
-        GGearboxData.next = gearshift_input_stage;
+        GGearboxData.replan = true;
     }
+
+    /* Shafts may still have to move if the shift was about to finish */
+    GGearboxData.next = gearshift_shafts;
+    gearshift_update_eta(0);
+    return true;
 }
 
 /* Reset pins and state machine if an emergency stop was triggered. */
@@ -496,6 +1104,18 @@ static void gearbox_handle_estop(void) {
      * reset them only on one shaft. */
     *GGearboxData.backgear.motor_reverse = false;
     *GGearboxData.backgear.motor_slow = false;
+    /* An interrupted shaft needs to start from scratch next time */
+    GGearboxData.input_stage.state = SHAFT_STATE_OFF;
+    GGearboxData.midrange.state = SHAFT_STATE_OFF;
+    GGearboxData.backgear.state = SHAFT_STATE_OFF;
+    GGearboxData.group_end = 0;
+    GGearboxData.replan = false;
+    *GGearboxData.eta_ms = 0;
+    *GGearboxData.progress = 0;
+    /* Do not start the spindle again once the e-stop is released */
+    GGearboxData.spindle_on_before_shift = false;
+    /* An interrupted shift does not count in the telemetry */
+    GGearboxData.recording = false;
 
     gearshift_stop(0); /* Will stop and reset twitching as well */
 }
@@ -503,3 +1123,39 @@ static void gearbox_handle_estop(void) {
 static bool gearshift_in_progress(void) {
     return GGearboxData.next != NULL;
 }
+
+static bool gearshift_spindle_at_speed(void) {
+    /* Stopping the spindle once it turned clears a failed spin-up, a spindle
+     * that did not start at all keeps it */
+    if (*GGearboxData.is_spindle_stopped) {
+        if (GGearboxData.spinup_turned) {
+            GGearboxData.spinup_failed = false;
+        }
+        return false;
+    }
+    GGearboxData.spinup_turned = true;
+    if (*GGearboxData.speed_feedback && !*GGearboxData.speed_reached) {
+        return false;
+    }
+    return !GGearboxData.spinup_failed;
+}
+
+static unsigned gearshift_target_index(void) {
+    if (GGearboxData.target == NULL) {
+        return GEARBOX_GEAR_INVALID;
+    }
+    return (unsigned)(GGearboxData.target - mh400e_gears);
+}
+
+static GearboxTraceState gearshift_trace_state(void) {
+    if (GGearboxData.next == NULL) {
+        return GEARBOX_TRACE_IDLE;
+    }
+    if (GGearboxData.next == gearshift_stop) {
+        return GEARBOX_TRACE_STOPPING;
+    }
+    if (GGearboxData.next == gearshift_spinup) {
+        return GEARBOX_TRACE_SPINUP;
+    }
+    return (GGearboxData.group_end != 0) ? GEARBOX_TRACE_MOVING : GEARBOX_TRACE_SHIFTING;
+}
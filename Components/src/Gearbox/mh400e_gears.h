@@ -3,20 +3,25 @@
 #ifndef MH400E_GEARS_H
 #define MH400E_GEARS_H
 
+#include "gearbox_trace.h"
 #include "mh400e_common.h"
 
 /* One time setup function to prepare data structures related to gearbox
  * switching*/
 FUNCTION(gearbox_setup);
 
+/* Create the shift counter pins of all gear pairs, call this function from
+ * EXTRA_SETUP. Returns 0 on success. */
+static int gearshift_export_pair_counts(int comp, const char *prefix);
+
 /* Construct masks from current gearbox status pins, call this function
- * once per iteration */
-static void update_current_pingroup_masks(void);
+ * once per iteration before gearshift_handle() */
+static void update_current_pingroup_masks(long period);
 
 /* Combine masks from each pin group to a value representing the current
  * gear setting. A return of NULL means that a corresponding value could
  * not be found, which may indicate a gearshift being in progress- */
-static PairT *get_current_gear(TreeNodeT *tree);
+static PairT *get_current_gear(void);
 
 /* Start gear shifting, parameter specifies the target gear that we want
  * to shift to.
@@ -24,6 +29,11 @@ static PairT *get_current_gear(TreeNodeT *tree);
  * and also start twitching. */
 static void gearshift_start(PairT *target_gear, long period);
 
+/* Change the target gear while a shift is in progress, starts a new shift
+ * if none is running. Returns false if the running shift can not be changed
+ * anymore because the spindle is already being started again. */
+static bool gearshift_retarget(PairT *target_gear, long period);
+
 /* Call this function once per each thread cycle to handle gearshifting,
  * implies that gearshift_start() has been called in order to set the
  * target gear.
@@ -37,4 +47,17 @@ static void gearbox_handle_estop(void);
 /* Returns true if a gear shifting operation is currently in progress */
 static bool gearshift_in_progress(void);
 
+/* Whether the spindle is at speed while no shift is in progress: it turns,
+ * the drive confirms the speed if spinup_feedback is set and it did not fail
+ * to reach its speed after the last shift */
+static bool gearshift_spindle_at_speed(void);
+
+/* Index of the gear the running or last shift heads to in mh400e_gears,
+ * GEARBOX_GEAR_INVALID if there was no shift yet */
+static unsigned gearshift_target_index(void);
+
+/* State of the gear shift state machine for the trace, the e-stop is not
+ * known here */
+static GearboxTraceState gearshift_trace_state(void);
+
 #endif // MH400E_GEARS_H
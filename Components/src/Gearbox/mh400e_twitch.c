@@ -4,6 +4,8 @@
 
 #include <stddef.h>
 
+static void twitch_stopping(long period);
+
 /* group twitch related data and states */
 static struct {
     bool want_cw;             /* next direction we want to twitch to */
@@ -12,9 +14,15 @@ static struct {
                                  in order to stop twitching while still respecting the
                                  configured delays. twitch_start() */
     long delay;               /* delay in ns to do "nothing", counted down to 0 */
+    long pulse_time;          /* time in ns since the current pulse started */
     hal_bit_t *cw;            /* pointer to twitch_cw pin */
     hal_bit_t *ccw;           /* pointer to twitch_ccw pin */
     hal_bit_t *trigger_estop; /* set to true to trigger an emergency stop */
+    hal_u32_t *pulse;         /* twitch pulse length in ms */
+    hal_u32_t *pulse_short;   /* pulse length in ms while the shaft is progressing */
+    hal_u32_t *pause;         /* pause between two pulses in ms */
+    hal_u32_t *pulses;        /* number of pulses so far */
+    bool progressing;         /* the shifted shaft is moving, see twitch_progress() */
     statefunc next;           /* next twitch state function to call */
 } GTwitchData;
 
@@ -23,45 +31,90 @@ FUNCTION(twitch_setup) {
     /* Initialize twitch data structure */
     GTwitchData.want_cw = true;
     GTwitchData.delay = 0;
+    GTwitchData.pulse_time = 0;
     GTwitchData.cw = &twitch_cw;
     GTwitchData.ccw = &twitch_ccw;
     GTwitchData.trigger_estop = &estop_out;
-    GTwitchData.next = twitch_stop;
+    GTwitchData.pulse = &twitch_pulse_ms;
+    GTwitchData.pulse_short = &twitch_pulse_short_ms;
+    GTwitchData.pause = &twitch_pause_ms;
+    GTwitchData.pulses = &twitch_pulse_count;
+    GTwitchData.progressing = false;
+    GTwitchData.next = twitch_stopping;
+    GTwitchData.finished = true;
+}
+
+/* Length of the next twitch pulse in ns */
+static long twitch_pulse_length(void) {
+    if (GTwitchData.progressing) {
+        return (long)*GTwitchData.pulse_short * 1000000L;
+    }
+    return (long)*GTwitchData.pulse * 1000000L;
+}
+
+/* Do not call this function directly, it will be setup by twitch_stop().
+ * Lets a running pulse finish, then switches both pins off. */
+static void twitch_stopping(long period) {
+    if (GTwitchData.delay > 0) {
+        GTwitchData.delay = GTwitchData.delay - period;
+        GTwitchData.pulse_time = GTwitchData.pulse_time + period;
+        return;
+    }
+
+    *GTwitchData.cw = false;
+    *GTwitchData.ccw = false;
     GTwitchData.finished = true;
 }
 
 /* Call this function to stop twitching.
  *
- * Stops twitching, respecting the specified delay, always sets the
- * next function pointer to twitch_stop(). Returns "true" if stopping
- * is done (i.e. all delays have elapsed and both pins are off). */
+ * Stops twitching, respecting the specified delay: a running pulse is
+ * finished, but only until it lasted the short pulse length, after that
+ * twitch_handle() switches both pins off and twitch_stop_completed() returns
+ * true. Can be called repeatedly, a period of 0 stops immediately. */
 static void twitch_stop(long period) {
     /* Both are off - nothing to do */
-    if ((*GTwitchData.cw == false) && (*GTwitchData.ccw == false)) {
+    if ((period <= 0) || ((*GTwitchData.cw == false) && (*GTwitchData.ccw == false))) {
+        *GTwitchData.cw = false;
+        *GTwitchData.ccw = false;
         GTwitchData.delay = 0;
-        GTwitchData.next = twitch_stop;
+        GTwitchData.next = twitch_stopping;
         GTwitchData.finished = true;
+        return;
     }
 
     /* At least one of the pins is on, respect the delay */
-    if (GTwitchData.delay > 0) {
-        GTwitchData.delay = GTwitchData.delay - period;
-        GTwitchData.next = twitch_stop;
+    if (GTwitchData.next != twitch_stopping) {
+        long limit = (long)*GTwitchData.pulse_short * 1000000L - GTwitchData.pulse_time;
+        if (GTwitchData.delay > limit) {
+            GTwitchData.delay = (limit > 0) ? limit : 0;
+        }
+        GTwitchData.next = twitch_stopping;
+        GTwitchData.finished = false;
     }
+}
 
-    *GTwitchData.cw = false;
-    *GTwitchData.ccw = false;
-    GTwitchData.next = twitch_stop;
-    GTwitchData.delay = 0;
-    GTwitchData.finished = true;
+/* Tell the twitch logic whether the shifted shaft is currently moving, in
+ * which case the gears mesh and shorter pulses are enough. A running long
+ * pulse is shortened as well. */
+static void twitch_progress(bool progressing) {
+    GTwitchData.progressing = progressing;
+
+    if (progressing && (*GTwitchData.cw || *GTwitchData.ccw)) {
+        long limit = twitch_pulse_length() - GTwitchData.pulse_time;
+        if (GTwitchData.delay > limit) {
+            GTwitchData.delay = (limit > 0) ? limit : 0;
+        }
+    }
 }
 
 /* Do not call this function directly, it will be setup by twitch_start().
- * Alternates between twitch_cw and twitch_ccw pins, respecting the
- * MH400E_TWITCH_KEEP_PIN_ON and MH400E_TWITCH_KEEP_PIN_OFF delays. */
+ * Alternates between twitch_cw and twitch_ccw pins, respecting the pulse
+ * and pause lengths set by the twitch-* parameters. */
 static void twitch_do(long period) {
     if (GTwitchData.delay > 0) {
         GTwitchData.delay = GTwitchData.delay - period;
+        GTwitchData.pulse_time = GTwitchData.pulse_time + period;
         GTwitchData.next = twitch_do;
         return;
     }
@@ -75,19 +128,21 @@ static void twitch_do(long period) {
             GTwitchData.want_cw = true;
         }
 
-        GTwitchData.delay = MH400E_TWITCH_KEEP_PIN_ON;
+        *GTwitchData.pulses = *GTwitchData.pulses + 1;
+        GTwitchData.delay = twitch_pulse_length();
+        GTwitchData.pulse_time = 0;
         GTwitchData.next = twitch_do;
         return;
     } else if (*GTwitchData.cw == true) {
         *GTwitchData.cw = false;
         GTwitchData.want_cw = false;
-        GTwitchData.delay = MH400E_TWITCH_KEEP_PIN_OFF;
+        GTwitchData.delay = (long)*GTwitchData.pause * 1000000L;
         GTwitchData.next = twitch_do;
         return;
     } else if (*GTwitchData.ccw == true) {
         *GTwitchData.ccw = false;
         GTwitchData.want_cw = true;
-        GTwitchData.delay = MH400E_TWITCH_KEEP_PIN_OFF;
+        GTwitchData.delay = (long)*GTwitchData.pause * 1000000L;
         GTwitchData.next = twitch_do;
         return;
     } else /* both are never allowed to be on */
@@ -102,20 +157,11 @@ static void twitch_do(long period) {
 
 /* Call this function to start twitching.
  *
- * Makes sure that we are in a defined state (both pins are off) and
- * sets up twitch_do() */
+ * Sets up twitch_do(). If a pulse of a previous twitch is still being
+ * stopped, twitch_do() lets it finish and continues with the pause, so the
+ * pins stay in a defined state. */
 static void twitch_start(long period) {
-    /* Precondition: both pins must be off before we start,
-     * if they are not - stop twitching in order to get into a defined
-     * state */
-    if ((*GTwitchData.cw != false) || (*GTwitchData.ccw != false)) {
-        twitch_stop(period);
-        /* stop function always resets the next pointer to twitch_stop */
-        GTwitchData.next = twitch_start;
-        return;
-    }
-
-    /* Precondition is met, we can do the actual twitching now. */
+    (void)period;
     GTwitchData.next = twitch_do;
     GTwitchData.finished = false;
 }
@@ -12,8 +12,8 @@ FUNCTION(twitch_setup);
 
 /* Call this function to start twitching.
  *
- * Makes sure that we are in a defined state (both pins are off) and
- * sets up twitch_do() */
+ * Sets up twitch_do(), which lets a pulse that is still being stopped finish
+ * before it continues alternating. */
 static void twitch_start(long period);
 
 /* Call this function once per each thread cycle to handle twitching */
@@ -21,10 +21,16 @@ static void twitch_handle(long period);
 
 /* Call this function to stop twitching.
  *
- * Stops twitching, respecting the specified delay, always sets the
- * next function pointer to twitch_stop(). */
+ * Stops twitching, respecting the specified delay: a running pulse is
+ * finished (cut down to the short pulse length) before both pins are switched
+ * off by twitch_handle(). Can be called repeatedly, a period of 0 stops
+ * immediately. */
 static void twitch_stop(long period);
 
+/* Tell the twitch logic whether the shifted shaft is currently moving, pulses
+ * are shorter while it does. */
+static void twitch_progress(bool progressing);
+
 /* Returns true if stop twitching operation completed. */
 static bool twitch_stop_completed(void);
 
@@ -6,26 +6,32 @@
  * @brief Determine the next state of the lubrication pump based on time and
  * input.
  *
- * @param time The current time in seconds.
+ * @param time The current time in nanoseconds.
  * @param input The input signals for the lubrication pump.
  * @param state The current lubrication state
  * @param config The lubrication pump config
- * @return The output signals for the lubrication pump.
+ * @return The earliest time at which the state can change while the input and
+ * the config stay the same, LUBRICATION_NEVER if only they can change it.
+ * Calling lubricate() again before that time has no effect.
  */
-void lubricate(
-    const float time,
+LubricationTime lubricate(
+    const LubricationTime time,
     const LubricationSignals input,
     LubricationState *state,
     const LubricationConfig config
 ) {
     if (state->state == LUBRICATION_STATE_ERROR) {
         // Once the ERROR state is reached a hard reset is required.
-        return;
+        return LUBRICATION_NEVER;
     }
 
-    if (config.is_enabled == false || input.is_motion_enabled == false) {
+    if (config.enabled == false || input.is_motion_enabled == false) {
+        // The first cycle is not skipped, it starts once motion is enabled
+        if (state->state == LUBRICATION_STATE_INITIALIZING) {
+            state->first_cycle_due = true;
+        }
         state->state = LUBRICATION_STATE_DISABLED;
-        return;
+        return LUBRICATION_NEVER;
     }
 
     switch (state->state) {
@@ -38,7 +44,8 @@ void lubricate(
         // semantic meaning, which is used in the GUI.
         case LUBRICATION_STATE_DISABLED:
         case LUBRICATION_STATE_IDLE:
-            if (time - state->last_cycle_end_time > config.interval) {
+            if (state->first_cycle_due || (time - state->last_cycle_end_time > config.interval)) {
+                state->first_cycle_due = false;
                 state->building_pressure_start_time = time;
                 state->lubrication_start_time = time;
                 state->state = LUBRICATION_STATE_BUILDING_PRESSURE;
@@ -52,12 +59,12 @@ void lubricate(
                 state->lubrication_start_time = time;
                 break;
             }
-            if (time - state->building_pressure_start_time > config.pressure_timeout) {
+            if (time - state->building_pressure_start_time > config.pressure_wait) {
                 state->state = LUBRICATION_STATE_ERROR;
             }
             break;
         case LUBRICATION_STATE_LUBRICATING:
-            if (time - state->lubrication_start_time > config.pressure_hold_time) {
+            if (time - state->lubrication_start_time > config.hold) {
                 state->state = LUBRICATION_STATE_IDLE;
                 state->last_cycle_end_time = time;
             }
@@ -65,4 +72,43 @@ void lubricate(
         default:
             break;
     }
+
+    // The transitions above happen once the time is past a deadline
+    switch (state->state) {
+        case LUBRICATION_STATE_IDLE:
+            return state->last_cycle_end_time + config.interval + 1;
+        case LUBRICATION_STATE_BUILDING_PRESSURE:
+            if (input.is_pressure_ok) {
+                return time;
+            }
+            return state->building_pressure_start_time + config.pressure_wait + 1;
+        case LUBRICATION_STATE_LUBRICATING:
+            return state->lubrication_start_time + config.hold + 1;
+        default:
+            return LUBRICATION_NEVER;
+    }
+}
+
+/**
+ * @brief Resume a schedule that was saved before a restart instead of starting
+ * with a lubrication cycle.
+ *
+ * Only has an effect before the first call of lubricate(). The next cycle
+ * starts once the interval since the previous one expired, right away if it
+ * already did.
+ *
+ * @param state The lubrication state, still LUBRICATION_STATE_INITIALIZING
+ * @param time The current time in nanoseconds.
+ * @param since_cycle The time between the end of the last cycle and the
+ * restart.
+ */
+void lubrication_resume(
+    LubricationState *state, const LubricationTime time, const LubricationTime since_cycle
+) {
+    if (state->state != LUBRICATION_STATE_INITIALIZING) {
+        return;
+    }
+
+    state->last_cycle_end_time = time - since_cycle;
+    state->state = LUBRICATION_STATE_IDLE;
 }
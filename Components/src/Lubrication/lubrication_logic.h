@@ -2,6 +2,19 @@
 #define LUBRICATION_LOGIC_H
 
 #include <stdbool.h>
+#include <stdint.h>
+
+/* Time and durations of the lubrication logic are integer nanoseconds, a 64 bit
+ * counter keeps the full resolution for centuries of uptime. */
+typedef int64_t LubricationTime;
+
+#define LUBRICATION_MILLISECONDS(ms) ((LubricationTime)(ms) * 1000000LL)
+#define LUBRICATION_SECONDS(s) ((LubricationTime)(s) * 1000000000LL)
+#define LUBRICATION_MINUTES(m) (LUBRICATION_SECONDS(m) * 60)
+
+/* Returned by lubricate() if only a change of the inputs or the config can
+ * cause the next state transition */
+#define LUBRICATION_NEVER INT64_MAX
 
 /* The possible states of the lubrication pump */
 typedef enum {
@@ -14,14 +27,16 @@ typedef enum {
     LUBRICATION_STATE_ERROR = 5              /* The lubrication pump is in an error state. */
 } LubricationStates;
 
-/* The configuration parameters for the lubrication pump */
+/* The configuration parameters for the lubrication pump.
+ *
+ * The member names differ from the pin and parameter names of lubrication.comp,
+ * halcompile turns those into macros. */
 typedef struct {
-    const bool is_enabled;          /* Whether the lubrication pump is enabled. */
-    const float interval;           /* The interval between lubrication cycles (in seconds). */
-    const float pressure_timeout;   /* The maximum time allowed to build pressure (in
-                                      seconds). */
-    const float pressure_hold_time; /* The time to keep the pump running after
-                                     pressure is reached (in seconds). */
+    const bool enabled;                  /* Whether the lubrication pump is enabled. */
+    const LubricationTime interval;      /* The interval between lubrication cycles. */
+    const LubricationTime pressure_wait; /* The maximum time allowed to build pressure. */
+    const LubricationTime hold;          /* The time to keep the pump running after
+                                            pressure is reached. */
 } LubricationConfig;
 
 /* The input signals for the lubrication pump logic */
@@ -34,13 +49,22 @@ typedef struct {
 /* The output signals from the lubrication pump logic */
 typedef struct {
     LubricationStates state; /* The current lubrication state. */
-    double building_pressure_start_time;
-    double lubrication_start_time;
-    double last_cycle_end_time;
+    LubricationTime building_pressure_start_time;
+    LubricationTime lubrication_start_time;
+    LubricationTime last_cycle_end_time;
+    bool first_cycle_due; /* The cycle that follows INITIALIZING is still due,
+                             motion was disabled at the start. */
 } LubricationState;
 
-void lubricate(
-    float time, LubricationSignals input, LubricationState *state, LubricationConfig config
+LubricationTime lubricate(
+    LubricationTime time,
+    LubricationSignals input,
+    LubricationState *state,
+    LubricationConfig config
+);
+
+void lubrication_resume(
+    LubricationState *state, LubricationTime time, LubricationTime since_cycle
 );
 
 #endif // LUBRICATION_LOGIC_H
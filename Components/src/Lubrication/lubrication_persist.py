@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Keep the lubrication schedule across LinuxCNC restarts.
+
+The realtime lubrication component runs a lubrication cycle once motion is
+first enabled in every session, because it does not know when the ways were
+lubricated last. This userspace component stores the wall clock time at which
+the last cycle ended and the accumulated motion time in a small state file.
+On the next start it hands the time since that cycle back to the component,
+including the time LinuxCNC was not running.
+
+Nothing is written from the servo thread: the lubrication component only
+publishes the schedule on its since-cycle-s and motion-time-s pins, this
+component reads them and writes the state file from its own process.
+
+The state file is a fixed size binary record followed by a CRC32 of the
+record. A missing, truncated or corrupt file is ignored, as is a cycle that
+ended after the current wall clock time. The lubrication component then runs
+a cycle once motion is enabled, as it does without this component.
+
+Usage in HAL, before `start`:
+
+    loadusr -Wn lubrication-persist lubrication_persist --file [LUBRICATION]STATE_FILE
+    net lubrication-resume lubrication-persist.resume => lubrication.resume
+    ...
+"""
+
+import argparse
+import os
+import pathlib
+import signal
+import struct
+import sys
+import time
+import zlib
+from typing import NamedTuple, Optional
+
+import hal
+
+MAGIC = b"MHLS"
+VERSION = 2
+# magic, version, reserved, cycle_end_s, motion_time_s
+RECORD = struct.Struct("<4sHHQQ")
+CHECKSUM = struct.Struct("<I")
+
+POLL_INTERVAL_S = 0.5
+
+
+class Schedule(NamedTuple):
+    cycle_end_s: int  # wall clock time the last cycle ended, seconds since the epoch
+    motion_time_s: int
+
+
+def encode(schedule: Schedule) -> bytes:
+    record = RECORD.pack(MAGIC, VERSION, 0, schedule.cycle_end_s, schedule.motion_time_s)
+    return record + CHECKSUM.pack(zlib.crc32(record))
+
+
+def decode(data: bytes) -> Optional[Schedule]:
+    """Return the schedule in `data`, or None if it is not a valid state file."""
+    if len(data) != RECORD.size + CHECKSUM.size:
+        return None
+    record, (checksum,) = data[: RECORD.size], CHECKSUM.unpack(data[RECORD.size :])
+    if zlib.crc32(record) != checksum:
+        return None
+    magic, version, _, cycle_end_s, motion_time_s = RECORD.unpack(record)
+    if magic != MAGIC or version != VERSION:
+        return None
+    return Schedule(cycle_end_s, motion_time_s)
+
+
+def load(path: pathlib.Path) -> Optional[Schedule]:
+    try:
+        return decode(path.read_bytes())
+    except OSError:
+        return None
+
+
+def save(path: pathlib.Path, schedule: Schedule) -> None:
+    """Replace the state file atomically, a crash leaves either the old or the new file."""
+    temporary = path.with_name(path.name + ".tmp")
+    with open(temporary, "wb") as file:
+        file.write(encode(schedule))
+        file.flush()
+        os.fsync(file.fileno())
+    os.replace(temporary, path)
+    directory = os.open(path.parent, os.O_RDONLY)
+    try:
+        os.fsync(directory)
+    finally:
+        os.close(directory)
+
+
+def since_cycle(schedule: Schedule, now: int) -> Optional[int]:
+    """Return the seconds between the end of the saved cycle and `now`, None if the
+    cycle ended in the future because the wall clock was set back."""
+    if schedule.cycle_end_s > now:
+        return None
+    return now - schedule.cycle_end_s
+
+
+def parse_args(argv: list[str]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--file", required=True, type=pathlib.Path, help="The state file")
+    parser.add_argument("--name", default="lubrication-persist", help="The HAL component name")
+    parser.add_argument(
+        "--save-interval",
+        default=60.0,
+        type=float,
+        help="Seconds between saves, a finished lubrication cycle is saved right away",
+    )
+    return parser.parse_args(argv)
+
+
+def main(argv: list[str]) -> int:
+    args = parse_args(argv)
+    path = args.file.expanduser().resolve()
+
+    component = hal.component(args.name)
+    component.newpin("resume", hal.HAL_BIT, hal.HAL_OUT)
+    component.newpin("resume-since-cycle-s", hal.HAL_U32, hal.HAL_OUT)
+    component.newpin("resume-motion-time-s", hal.HAL_U32, hal.HAL_OUT)
+    component.newpin("schedule-valid", hal.HAL_BIT, hal.HAL_IN)
+    component.newpin("since-cycle-s", hal.HAL_U32, hal.HAL_IN)
+    component.newpin("motion-time-s", hal.HAL_U32, hal.HAL_IN)
+
+    # The pins have to hold the saved schedule before the threads are started
+    saved = load(path)
+    downtime = since_cycle(saved, int(time.time())) if saved is not None else None
+    if downtime is not None:
+        component["resume-since-cycle-s"] = min(downtime, 0xFFFFFFFF)
+        component["resume-motion-time-s"] = min(saved.motion_time_s, 0xFFFFFFFF)
+        component["resume"] = True
+    else:
+        print(f"{args.name}: no valid state in {path}, starting with a lubrication cycle", file=sys.stderr)
+    component.ready()
+
+    def terminate(signum, frame):
+        raise SystemExit(0)
+
+    signal.signal(signal.SIGTERM, terminate)
+
+    last: Optional[Schedule] = None
+    written: Optional[Schedule] = saved
+    last_since_cycle_s: Optional[int] = None
+    last_save = time.monotonic()
+    try:
+        while True:
+            time.sleep(POLL_INTERVAL_S)
+            if not component["schedule-valid"]:
+                continue
+            since_cycle_s = component["since-cycle-s"]
+            cycle_finished = last_since_cycle_s is not None and since_cycle_s < last_since_cycle_s
+            last_since_cycle_s = since_cycle_s
+            last = Schedule(int(time.time()) - since_cycle_s, component["motion-time-s"])
+            if last == written:
+                continue
+            if cycle_finished or time.monotonic() - last_save >= args.save_interval:
+                save(path, last)
+                written = last
+                last_save = time.monotonic()
+    except (KeyboardInterrupt, SystemExit):
+        pass
+    finally:
+        if last is not None and last != written:
+            save(path, last)
+        component.exit()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,88 @@
+#include "lubrication_telemetry.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Add the time-to-pressure of a lubrication cycle and update the
+ * statistics of the window.
+ *
+ * Runs once per lubrication cycle, the cost is a pass over the window.
+ *
+ * @param telemetry The telemetry, zero initialized before the first cycle
+ * @param time_to_pressure The time between enabling the pump and reaching the
+ * pressure in nanoseconds.
+ */
+void lubrication_telemetry_record(
+    LubricationTelemetry *telemetry, const LubricationTime time_to_pressure
+) {
+    telemetry->samples[telemetry->next_sample] = time_to_pressure;
+    telemetry->next_sample = (telemetry->next_sample + 1) % LUBRICATION_TELEMETRY_WINDOW;
+    if (telemetry->sample_count < LUBRICATION_TELEMETRY_WINDOW) {
+        telemetry->sample_count++;
+    }
+    telemetry->total_cycles++;
+    telemetry->latest = time_to_pressure;
+
+    const int64_t count = telemetry->sample_count;
+    const unsigned oldest =
+        (telemetry->next_sample + LUBRICATION_TELEMETRY_WINDOW - telemetry->sample_count) %
+        LUBRICATION_TELEMETRY_WINDOW;
+    LubricationTime minimum = time_to_pressure;
+    LubricationTime maximum = time_to_pressure;
+    int64_t sum = 0;
+    int64_t weighted_sum = 0;
+
+    // Sample i is the i-th oldest, its index is the x of the trend
+    for (int64_t i = 0; i < count; i++) {
+        const LubricationTime sample =
+            telemetry->samples[(oldest + i) % LUBRICATION_TELEMETRY_WINDOW];
+        minimum = (sample < minimum) ? sample : minimum;
+        maximum = (sample > maximum) ? sample : maximum;
+        sum += sample;
+        weighted_sum += i * sample;
+    }
+
+    telemetry->minimum = minimum;
+    telemetry->maximum = maximum;
+    telemetry->mean = sum / count;
+
+    // slope = (n * sum(x * y) - sum(x) * sum(y)) / (n * sum(x^2) - sum(x)^2)
+    // with x = 0 .. n - 1. The time-to-pressure is limited by the pressure
+    // timeout, the products stay far below the range of int64_t.
+    const int64_t sum_x = count * (count - 1) / 2;
+    const int64_t sum_x2 = (count - 1) * count * (2 * count - 1) / 6;
+    const int64_t denominator = count * sum_x2 - sum_x * sum_x;
+    telemetry->trend =
+        (denominator == 0) ? 0 : (count * weighted_sum - sum_x * sum) / denominator;
+}
+
+/**
+ * @brief The hold time of a lubrication cycle in which the pressure built up
+ * in time_to_pressure.
+ *
+ * A pump that builds its pressure quickly has pushed the oil through the
+ * lines, the hold time is factor_percent of the time-to-pressure. It never
+ * exceeds the configured hold time and never drops below minimum_hold.
+ *
+ * @param time_to_pressure The time-to-pressure of the current cycle
+ * @param hold The configured hold time
+ * @param minimum_hold The shortest hold time
+ * @param factor_percent The hold time in percent of the time-to-pressure
+ * @return The hold time for the current cycle
+ */
+LubricationTime lubrication_adaptive_hold(
+    const LubricationTime time_to_pressure,
+    const LubricationTime hold,
+    const LubricationTime minimum_hold,
+    const uint32_t factor_percent
+) {
+    const LubricationTime adapted = time_to_pressure / 100 * factor_percent;
+
+    if (adapted >= hold) {
+        return hold;
+    }
+    if (adapted <= minimum_hold) {
+        return (minimum_hold < hold) ? minimum_hold : hold;
+    }
+    return adapted;
+}
@@ -0,0 +1,44 @@
+#ifndef LUBRICATION_TELEMETRY_H
+#define LUBRICATION_TELEMETRY_H
+
+#include "lubrication_logic.h"
+
+#include <stdint.h>
+
+/* The number of lubrication cycles the rolling statistics are taken over */
+#define LUBRICATION_TELEMETRY_WINDOW 16
+
+/* Time-to-pressure of the recent lubrication cycles. A clogged filter or a
+ * worn pump shows up as a rising time-to-pressure long before the pressure
+ * timeout latches LUBRICATION_STATE_ERROR.
+ *
+ * The member names differ from the pin and parameter names of lubrication.comp,
+ * halcompile turns those into macros. */
+typedef struct {
+    LubricationTime samples[LUBRICATION_TELEMETRY_WINDOW]; /* Oldest first once full */
+    unsigned sample_count;
+    unsigned next_sample; /* Where the next sample is written */
+    uint32_t total_cycles;
+
+    /* Statistics of the samples in the window */
+    LubricationTime latest;
+    LubricationTime minimum;
+    LubricationTime mean;
+    LubricationTime maximum;
+    /* Least squares slope of the samples in the window, the change of the
+     * time-to-pressure per lubrication cycle */
+    LubricationTime trend;
+} LubricationTelemetry;
+
+void lubrication_telemetry_record(
+    LubricationTelemetry *telemetry, LubricationTime time_to_pressure
+);
+
+LubricationTime lubrication_adaptive_hold(
+    LubricationTime time_to_pressure,
+    LubricationTime hold,
+    LubricationTime minimum_hold,
+    uint32_t factor_percent
+);
+
+#endif // LUBRICATION_TELEMETRY_H
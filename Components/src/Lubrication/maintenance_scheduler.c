@@ -0,0 +1,225 @@
+#include "maintenance_scheduler.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static bool earlier(const MaintenanceScheduler *scheduler, unsigned a, unsigned b) {
+    return scheduler->tasks[scheduler->heap[a]].deadline <
+           scheduler->tasks[scheduler->heap[b]].deadline;
+}
+
+static void swap(MaintenanceScheduler *scheduler, unsigned a, unsigned b) {
+    const unsigned task = scheduler->heap[a];
+
+    scheduler->heap[a] = scheduler->heap[b];
+    scheduler->heap[b] = task;
+    scheduler->tasks[scheduler->heap[a]].heap_position = a;
+    scheduler->tasks[scheduler->heap[b]].heap_position = b;
+}
+
+static void sift_up(MaintenanceScheduler *scheduler, unsigned position) {
+    while (position > 0) {
+        const unsigned parent = (position - 1) / 2;
+        if (!earlier(scheduler, position, parent)) {
+            return;
+        }
+        swap(scheduler, position, parent);
+        position = parent;
+    }
+}
+
+static void sift_down(MaintenanceScheduler *scheduler, unsigned position) {
+    for (;;) {
+        const unsigned left = 2 * position + 1;
+        const unsigned right = left + 1;
+        unsigned earliest = position;
+
+        if (left < scheduler->task_count && earlier(scheduler, left, earliest)) {
+            earliest = left;
+        }
+        if (right < scheduler->task_count && earlier(scheduler, right, earliest)) {
+            earliest = right;
+        }
+        if (earliest == position) {
+            return;
+        }
+        swap(scheduler, position, earliest);
+        position = earliest;
+    }
+}
+
+static void set_deadline(
+    MaintenanceScheduler *scheduler, unsigned task, LubricationTime deadline
+) {
+    MaintenanceTask *entry = &scheduler->tasks[task];
+    const LubricationTime previous = entry->deadline;
+
+    entry->deadline = deadline;
+    if (deadline < previous) {
+        sift_up(scheduler, entry->heap_position);
+    } else if (deadline > previous) {
+        sift_down(scheduler, entry->heap_position);
+    }
+}
+
+/**
+ * @brief Initialize a scheduler with disabled tasks that are all due right
+ * away.
+ *
+ * @param scheduler The scheduler
+ * @param task_count The number of tasks, at most MAINTENANCE_MAX_TASKS
+ */
+void maintenance_init(MaintenanceScheduler *scheduler, unsigned task_count) {
+    if (task_count > MAINTENANCE_MAX_TASKS) {
+        task_count = MAINTENANCE_MAX_TASKS;
+    }
+
+    scheduler->task_count = task_count;
+    scheduler->is_motion_enabled = false;
+    scheduler->awaiting_confirmation = 0;
+
+    for (unsigned task = 0; task < task_count; task++) {
+        MaintenanceTask *entry = &scheduler->tasks[task];
+
+        entry->cycle.state = LUBRICATION_STATE_INITIALIZING;
+        entry->cycle.building_pressure_start_time = 0;
+        entry->cycle.lubrication_start_time = 0;
+        entry->cycle.last_cycle_end_time = 0;
+        entry->cycle.first_cycle_due = false;
+        entry->deadline = 0;
+        entry->heap_position = task;
+        entry->is_enabled = false;
+        entry->cycle_interval = 0;
+        entry->confirm_wait = 0;
+        entry->hold_duration = 0;
+        scheduler->heap[task] = task;
+    }
+}
+
+/**
+ * @brief Change the config of a task, the task is evaluated again at the next
+ * call of maintenance_next_due() if anything changed.
+ *
+ * @param scheduler The scheduler
+ * @param task The index of the task
+ * @param time The current time in nanoseconds
+ * @param config The new config, pressure_wait is the time allowed for the
+ * confirmation input
+ */
+void maintenance_configure(
+    MaintenanceScheduler *scheduler,
+    const unsigned task,
+    const LubricationTime time,
+    const LubricationConfig config
+) {
+    MaintenanceTask *entry = &scheduler->tasks[task];
+
+    if (entry->is_enabled == config.enabled && entry->cycle_interval == config.interval &&
+        entry->confirm_wait == config.pressure_wait && entry->hold_duration == config.hold) {
+        return;
+    }
+
+    entry->is_enabled = config.enabled;
+    entry->cycle_interval = config.interval;
+    entry->confirm_wait = config.pressure_wait;
+    entry->hold_duration = config.hold;
+    maintenance_wake(scheduler, task, time);
+}
+
+/**
+ * @brief Enable or disable all tasks, like the motion-enabled input of the
+ * lubrication component.
+ *
+ * Every task is evaluated again when the value changes, otherwise this has no
+ * cost.
+ */
+void maintenance_set_motion_enabled(
+    MaintenanceScheduler *scheduler, const LubricationTime time, const bool is_motion_enabled
+) {
+    if (scheduler->is_motion_enabled == is_motion_enabled) {
+        return;
+    }
+
+    scheduler->is_motion_enabled = is_motion_enabled;
+    for (unsigned task = 0; task < scheduler->task_count; task++) {
+        maintenance_wake(scheduler, task, time);
+    }
+}
+
+/**
+ * @brief Make a task due, e.g. because its confirmation input changed.
+ */
+void maintenance_wake(
+    MaintenanceScheduler *scheduler, const unsigned task, const LubricationTime time
+) {
+    if (scheduler->tasks[task].deadline > time) {
+        set_deadline(scheduler, task, time);
+    }
+}
+
+/**
+ * @brief Find the task with the earliest deadline if it is due.
+ *
+ * Only the root of the heap is compared, the cost does not depend on the
+ * number of tasks.
+ *
+ * @param scheduler The scheduler
+ * @param time The current time in nanoseconds
+ * @param task Set to the index of the due task
+ * @return Whether a task is due
+ */
+bool maintenance_next_due(
+    const MaintenanceScheduler *scheduler, const LubricationTime time, unsigned *task
+) {
+    if (scheduler->task_count == 0 || scheduler->tasks[scheduler->heap[0]].deadline > time) {
+        return false;
+    }
+
+    *task = scheduler->heap[0];
+    return true;
+}
+
+/**
+ * @brief Run lubricate() for a task and move it to its next deadline.
+ *
+ * The new deadline is always later than time, a loop over
+ * maintenance_next_due() evaluates every task at most once.
+ *
+ * @param scheduler The scheduler
+ * @param task The index of the task
+ * @param time The current time in nanoseconds
+ * @param is_confirmed The confirmation input of the task, e.g. a pressure or
+ * level switch
+ */
+void maintenance_evaluate(
+    MaintenanceScheduler *scheduler,
+    const unsigned task,
+    const LubricationTime time,
+    const bool is_confirmed
+) {
+    MaintenanceTask *entry = &scheduler->tasks[task];
+    const LubricationSignals signals = {
+        .is_motion_enabled = scheduler->is_motion_enabled, .is_pressure_ok = is_confirmed
+    };
+    const LubricationConfig config = {
+        .enabled = entry->is_enabled,
+        .interval = entry->cycle_interval,
+        .pressure_wait = entry->confirm_wait,
+        .hold = entry->hold_duration
+    };
+
+    LubricationTime deadline = lubricate(time, signals, &entry->cycle, config);
+
+    // A cycle that was started with the confirmation already present proceeds
+    // right away, lubricate() reports this with a deadline of now
+    if (deadline <= time) {
+        deadline = lubricate(time, signals, &entry->cycle, config);
+    }
+
+    if (entry->cycle.state == LUBRICATION_STATE_BUILDING_PRESSURE) {
+        scheduler->awaiting_confirmation |= (uint32_t)1 << task;
+    } else {
+        scheduler->awaiting_confirmation &= ~((uint32_t)1 << task);
+    }
+    set_deadline(scheduler, task, deadline);
+}
@@ -0,0 +1,63 @@
+#ifndef MAINTENANCE_SCHEDULER_H
+#define MAINTENANCE_SCHEDULER_H
+
+#include "lubrication_logic.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Scheduler for maintenance tasks that follow the same interval, confirm and
+ * hold cycle as the lubrication pump: way oil, coolant tank flush, spindle oil
+ * checks and the like. Every task runs lubricate() with its own state and
+ * config, the deadlines it returns are kept in a binary min-heap so only the
+ * earliest one has to be compared while no task is due.
+ *
+ * The member names differ from the pin and parameter names of maintenance.comp,
+ * halcompile turns those into macros. */
+
+/* Tasks per scheduler, also the size of the pin arrays of maintenance.comp */
+#define MAINTENANCE_MAX_TASKS 16
+
+typedef struct {
+    LubricationState cycle;
+    LubricationTime deadline; /* The next time lubricate() has to run for this task */
+    unsigned heap_position;   /* Index of this task in MaintenanceScheduler.heap */
+
+    /* The config used by lubricate(), changed by maintenance_configure() */
+    bool is_enabled;
+    LubricationTime cycle_interval;
+    LubricationTime confirm_wait;
+    LubricationTime hold_duration;
+} MaintenanceTask;
+
+typedef struct {
+    unsigned task_count;
+    bool is_motion_enabled;
+    /* Bit n is set while task n waits for its confirmation input */
+    uint32_t awaiting_confirmation;
+    MaintenanceTask tasks[MAINTENANCE_MAX_TASKS];
+    /* Task indices, ordered as a binary min-heap on their deadline */
+    unsigned heap[MAINTENANCE_MAX_TASKS];
+} MaintenanceScheduler;
+
+void maintenance_init(MaintenanceScheduler *scheduler, unsigned task_count);
+
+void maintenance_configure(
+    MaintenanceScheduler *scheduler, unsigned task, LubricationTime time, LubricationConfig config
+);
+
+void maintenance_set_motion_enabled(
+    MaintenanceScheduler *scheduler, LubricationTime time, bool is_motion_enabled
+);
+
+void maintenance_wake(MaintenanceScheduler *scheduler, unsigned task, LubricationTime time);
+
+bool maintenance_next_due(
+    const MaintenanceScheduler *scheduler, LubricationTime time, unsigned *task
+);
+
+void maintenance_evaluate(
+    MaintenanceScheduler *scheduler, unsigned task, LubricationTime time, bool is_confirmed
+);
+
+#endif // MAINTENANCE_SCHEDULER_H
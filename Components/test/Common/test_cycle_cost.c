@@ -0,0 +1,69 @@
+#include "cycle_cost.h"
+#include "unity.h"
+
+#include <string.h>
+
+static CycleCost cost;
+
+void setUp(void) { memset(&cost, 0, sizeof(cost)); }
+
+void tearDown(void) {}
+
+void test_first_call_sets_every_statistic(void) {
+    cycle_cost_record(&cost, 1200, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(1200, cost.latest);
+    TEST_ASSERT_EQUAL_UINT32(1200, cost.highest);
+    TEST_ASSERT_EQUAL_UINT32(1200, cost.average);
+    TEST_ASSERT_EQUAL_UINT32(0, cost.over_budget_calls);
+}
+
+void test_maximum_keeps_the_most_expensive_call(void) {
+    cycle_cost_record(&cost, 1200, 0);
+    cycle_cost_record(&cost, 9000, 0);
+    cycle_cost_record(&cost, 800, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(800, cost.latest);
+    TEST_ASSERT_EQUAL_UINT32(9000, cost.highest);
+}
+
+void test_mean_moves_a_sixteenth_towards_each_call(void) {
+    cycle_cost_record(&cost, 1600, 0);
+    cycle_cost_record(&cost, 3200, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(1700, cost.average);
+}
+
+void test_mean_settles_on_a_constant_cost(void) {
+    cycle_cost_record(&cost, 100000, 0);
+    for (unsigned i = 0; i < 1000; i++) {
+        cycle_cost_record(&cost, 500, 0);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(500, cost.average);
+}
+
+void test_calls_above_the_budget_are_counted(void) {
+    cycle_cost_record(&cost, 999, 1000);
+    cycle_cost_record(&cost, 1000, 1000);
+    cycle_cost_record(&cost, 1001, 1000);
+    cycle_cost_record(&cost, 50000, 1000);
+
+    TEST_ASSERT_EQUAL_UINT32(2, cost.over_budget_calls);
+}
+
+void test_budget_of_zero_counts_nothing(void) {
+    cycle_cost_record(&cost, 50000, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(0, cost.over_budget_calls);
+}
+
+void test_cost_is_clamped_to_the_range_of_a_pin(void) {
+    cycle_cost_record(&cost, 0x100000000LL, 0);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, cost.latest);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, cost.average);
+
+    cycle_cost_record(&cost, -5, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, cost.latest);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, cost.highest);
+}
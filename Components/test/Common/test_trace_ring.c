@@ -0,0 +1,110 @@
+#include "trace_ring.h"
+#include "unity.h"
+
+#include <stdint.h>
+
+#define CAPACITY 8
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t check;
+} Record;
+
+static union {
+    TraceRing ring;
+    unsigned char memory[sizeof(TraceRing) + CAPACITY * sizeof(Record)];
+} storage;
+
+static TraceRing *ring = &storage.ring;
+
+static bool push(uint32_t sequence) {
+    const Record record = {sequence, ~sequence};
+    return trace_ring_push(ring, &record);
+}
+
+void setUp(void) { TEST_ASSERT_TRUE(trace_ring_init(ring, sizeof(Record), CAPACITY)); }
+
+void tearDown(void) {}
+
+void test_size_includes_the_header_and_all_records(void) {
+    TEST_ASSERT_EQUAL(sizeof(storage), trace_ring_size(sizeof(Record), CAPACITY));
+}
+
+void test_capacity_must_be_a_power_of_two(void) {
+    TEST_ASSERT_FALSE(trace_ring_init(ring, sizeof(Record), 0));
+    TEST_ASSERT_FALSE(trace_ring_init(ring, sizeof(Record), 6));
+}
+
+void test_ring_is_only_valid_for_the_record_size_it_was_made_for(void) {
+    TEST_ASSERT_TRUE(trace_ring_valid(ring, sizeof(Record)));
+    TEST_ASSERT_FALSE(trace_ring_valid(ring, sizeof(Record) + 4));
+}
+
+void test_empty_ring_pops_nothing(void) {
+    Record records[CAPACITY];
+
+    TEST_ASSERT_EQUAL_UINT32(0, trace_ring_pop(ring, records, CAPACITY));
+}
+
+void test_records_are_popped_oldest_first(void) {
+    Record records[CAPACITY];
+
+    push(1);
+    push(2);
+    push(3);
+
+    TEST_ASSERT_EQUAL_UINT32(2, trace_ring_pop(ring, records, 2));
+    TEST_ASSERT_EQUAL_UINT32(1, records[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(2, records[1].sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, trace_ring_pop(ring, records, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT32(3, records[0].sequence);
+}
+
+void test_full_ring_drops_and_counts_new_records(void) {
+    Record records[CAPACITY];
+
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+        TEST_ASSERT_TRUE(push(i));
+    }
+    TEST_ASSERT_FALSE(push(100));
+    TEST_ASSERT_FALSE(push(101));
+    TEST_ASSERT_EQUAL_UINT32(2, ring->dropped);
+
+    /* the oldest records are kept */
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY, trace_ring_pop(ring, records, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT32(0, records[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY - 1, records[CAPACITY - 1].sequence);
+    TEST_ASSERT_TRUE(push(102));
+}
+
+void test_pop_copies_records_that_wrap_around_the_end(void) {
+    Record records[CAPACITY];
+
+    for (uint32_t i = 0; i < 6; i++) {
+        push(i);
+    }
+    trace_ring_pop(ring, records, 6);
+    for (uint32_t i = 6; i < 12; i++) {
+        push(i);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(6, trace_ring_pop(ring, records, CAPACITY));
+    for (uint32_t i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL_UINT32(6 + i, records[i].sequence);
+        TEST_ASSERT_EQUAL_HEX32(~(6 + i), records[i].check);
+    }
+}
+
+void test_counters_may_wrap_around(void) {
+    Record records[CAPACITY];
+
+    ring->written = UINT32_MAX - 2;
+    ring->consumed = UINT32_MAX - 2;
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(push(i));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(5, trace_ring_pop(ring, records, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT32(4, records[4].sequence);
+    TEST_ASSERT_EQUAL_UINT32(0, ring->dropped);
+}
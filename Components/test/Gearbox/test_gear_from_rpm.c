@@ -0,0 +1,87 @@
+#include "gearbox_logic.h"
+#include "gearbox_lookup.h"
+#include "unity.h"
+
+#include <math.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/* Straightforward reference: closest non zero speed, ties select the higher one. */
+static unsigned closest_gear(const double rpm) {
+    if (rpm <= 0) {
+        return GEARBOX_NEUTRAL_GEAR;
+    }
+
+    unsigned best = GEARBOX_MIN_RPM_GEAR;
+    for (unsigned i = GEARBOX_MIN_RPM_GEAR; i < SUPPORTED_SPEEDS_COUNT; ++i) {
+        const double diff = rpm - supported_speeds[i].rpm;
+        const double best_diff = rpm - supported_speeds[best].rpm;
+        if (diff * diff <= best_diff * best_diff) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static bool same_target_state(
+    const TargetGearboxMicroSwitchesState a, const TargetGearboxMicroSwitchesState b
+) {
+    return a.input == b.input && a.middle == b.middle && a.reducer == b.reducer;
+}
+
+void test_gear_from_rpm_selects_closest_speed_from_0_to_5000_rpm(void) {
+    int failures = 0;
+
+    /* quarter rpm steps hit every midpoint between two speeds exactly */
+    for (unsigned quarters = 0; quarters <= 5000 * 4; ++quarters) {
+        const float rpm = (float)quarters / 4.0f;
+        const unsigned expected = closest_gear(rpm);
+        const unsigned actual = gearbox_gear_from_rpm(rpm);
+        if (actual != expected) {
+            printf("FAIL: rpm=%.2f got gear %u, expected %u\n", rpm, actual, expected);
+            failures++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, failures, "Some rpm quantization tests failed");
+}
+
+void test_get_target_state_agrees_with_gear_from_rpm_from_0_to_5000_rpm(void) {
+    int failures = 0;
+
+    for (unsigned quarters = 0; quarters <= 5000 * 4; ++quarters) {
+        const float rpm = (float)quarters / 4.0f;
+        const unsigned gear = gearbox_gear_from_rpm(rpm);
+        const TargetGearboxMicroSwitchesState expected =
+            get_target_state((float)supported_speeds[gear].rpm);
+        if (!same_target_state(get_target_state(rpm), expected)) {
+            printf(
+                "FAIL: rpm=%.2f does not select the state of %u rpm\n", rpm,
+                supported_speeds[gear].rpm
+            );
+            failures++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, failures, "Some target state quantization tests failed");
+}
+
+void test_gear_from_rpm_rounds_midpoints_up(void) {
+    TEST_ASSERT_EQUAL(2, gearbox_gear_from_rpm(90.0f));
+    TEST_ASSERT_EQUAL(1, gearbox_gear_from_rpm(89.9f));
+    TEST_ASSERT_EQUAL(4, gearbox_gear_from_rpm(142.5f));
+    TEST_ASSERT_EQUAL(3, gearbox_gear_from_rpm(142.4f));
+}
+
+void test_gear_from_rpm_selects_neutral_for_zero_negative_and_nan(void) {
+    TEST_ASSERT_EQUAL(GEARBOX_NEUTRAL_GEAR, gearbox_gear_from_rpm(0.0f));
+    TEST_ASSERT_EQUAL(GEARBOX_NEUTRAL_GEAR, gearbox_gear_from_rpm(-100.0f));
+    TEST_ASSERT_EQUAL(GEARBOX_NEUTRAL_GEAR, gearbox_gear_from_rpm(NAN));
+}
+
+void test_gear_from_rpm_clamps_to_lowest_and_highest_speed(void) {
+    TEST_ASSERT_EQUAL(GEARBOX_MIN_RPM_GEAR, gearbox_gear_from_rpm(0.1f));
+    TEST_ASSERT_EQUAL(SUPPORTED_SPEEDS_COUNT - 1, gearbox_gear_from_rpm(1e30f));
+}
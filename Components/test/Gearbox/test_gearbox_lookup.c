@@ -0,0 +1,41 @@
+#include "gearbox_logic.h"
+#include "gearbox_lookup.h"
+#include "unity.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_gear_from_bitmask_returns_index_of_every_supported_speed(void) {
+    for (size_t i = 1; i < SUPPORTED_SPEEDS_COUNT; ++i) {
+        TEST_ASSERT_EQUAL(i, gearbox_gear_from_bitmask(supported_speeds[i].bitmask));
+    }
+}
+
+void test_gear_from_bitmask_returns_neutral_for_centered_reducer(void) {
+    for (unsigned upper = 0; upper < 256; ++upper) {
+        TEST_ASSERT_EQUAL(0, gearbox_gear_from_bitmask((upper << 4) | supported_speeds[0].bitmask));
+    }
+}
+
+void test_gear_from_bitmask_returns_invalid_while_shaft_is_moving(void) {
+    /* input stage has left the center position, no switch is closed */
+    TEST_ASSERT_EQUAL(GEARBOX_GEAR_INVALID, gearbox_gear_from_bitmask(1097 & ~0x400));
+    TEST_ASSERT_EQUAL(GEARBOX_GEAR_INVALID, gearbox_gear_from_bitmask(0));
+}
+
+void test_gear_from_bitmask_returns_invalid_for_more_than_12_bits(void) {
+    TEST_ASSERT_EQUAL(GEARBOX_GEAR_INVALID, gearbox_gear_from_bitmask(1 << 12));
+    TEST_ASSERT_EQUAL(GEARBOX_GEAR_INVALID, gearbox_gear_from_bitmask((1 << 12) | 1097));
+}
+
+void test_gear_from_bitmask_matches_exactly_one_gear_per_bitmask(void) {
+    unsigned matches = 0;
+    for (unsigned bitmask = 0; bitmask < GEARBOX_BITMASK_COUNT; ++bitmask) {
+        if (gearbox_gear_from_bitmask(bitmask) != GEARBOX_GEAR_INVALID) {
+            matches++;
+        }
+    }
+    /* 256 neutral entries and one entry for every other gear */
+    TEST_ASSERT_EQUAL(256 + SUPPORTED_SPEEDS_COUNT - 1, matches);
+}
@@ -0,0 +1,100 @@
+#include "gearbox_policy.h"
+#include "unity.h"
+
+/* Gear indices used below */
+#define GEAR_400 8
+#define GEAR_500 9
+#define GEAR_630 10
+#define GEAR_800 11
+
+static const GearboxShiftPolicy NO_POLICY = {0, 0, false};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_policy_without_options_shifts_to_the_quantized_gear(void) {
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&NO_POLICY, GEAR_500, 630, 1, 500)
+    );
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&NO_POLICY, GEAR_500, 440, 1, 500)
+    );
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_SAME_GEAR, gearbox_policy_decide(&NO_POLICY, GEAR_500, 540, 1, 500)
+    );
+}
+
+void test_policy_stays_within_tolerance_band(void) {
+    const GearboxShiftPolicy policy = {20, 0, false};
+
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_STAY_TOLERANCE, gearbox_policy_decide(&policy, GEAR_500, 600, 1, 500)
+    );
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_STAY_TOLERANCE, gearbox_policy_decide(&policy, GEAR_500, 400, 1, 500)
+    );
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 610, 1, 500));
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 390, 1, 500));
+}
+
+void test_policy_hysteresis_moves_the_gear_boundary_outwards(void) {
+    const GearboxShiftPolicy policy = {0, 5, false};
+
+    /* boundary between 500 and 630 is 565, with 5% hysteresis 593.25 */
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_STAY_HYSTERESIS, gearbox_policy_decide(&policy, GEAR_500, 590, 1, 500)
+    );
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 595, 1, 500));
+
+    /* and back down from 630 the boundary is 565 * 0.95 = 536.75 */
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_STAY_HYSTERESIS, gearbox_policy_decide(&policy, GEAR_630, 540, 1, 630)
+    );
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_630, 530, 1, 630));
+
+    /* from 400 the same request of 540 picks 500 again */
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_400, 540, 1, 400));
+}
+
+void test_policy_hysteresis_only_holds_back_the_neighbouring_gear(void) {
+    const GearboxShiftPolicy policy = {0, 30, false};
+
+    /* 720 quantizes to 800, two gears up from 500, although it is below the
+     * boundary to 630 moved by 30% (734.5) */
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 720, 1, 500));
+    /* 420 quantizes to 400, two gears down from 630, although it is above the
+     * boundary to 500 moved by 30% (395.5) */
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_630, 420, 1, 630));
+    /* the neighbour is still held back */
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_STAY_HYSTERESIS, gearbox_policy_decide(&policy, GEAR_800, 700, 1, 800)
+    );
+}
+
+void test_policy_override_lock_ignores_override_changes(void) {
+    const GearboxShiftPolicy policy = {0, 0, true};
+
+    /* S500 with 130% override */
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_STAY_OVERRIDE, gearbox_policy_decide(&policy, GEAR_500, 650, 1.3f, 500)
+    );
+    /* a new S word is not an override change */
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 630, 1.0f, 500)
+    );
+    /* unknown override */
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 650, 0, 500));
+}
+
+void test_policy_never_avoids_neutral_or_unknown_gears(void) {
+    const GearboxShiftPolicy policy = {100, 50, true};
+
+    TEST_ASSERT_EQUAL(GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEAR_500, 0, 1, 500));
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEARBOX_NEUTRAL_GEAR, 500, 1, 500)
+    );
+    TEST_ASSERT_EQUAL(
+        GEARBOX_POLICY_SHIFT, gearbox_policy_decide(&policy, GEARBOX_GEAR_INVALID, 500, 1, 500)
+    );
+}
@@ -0,0 +1,122 @@
+#include "gearbox_logic.h"
+#include "gearbox_lookup.h"
+#include "unity.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/* Position of a shaft from its 4 bit mask, 0 left, 1 center, 2 right. Shafts
+ * that do not matter for a gear (neutral) are planned as centered. */
+static int shaft_position(unsigned bitmask, unsigned shaft) {
+    const unsigned nibble = (bitmask >> (4 * (GEARBOX_SHAFT_COUNT - 1 - shaft))) & 0xf;
+    switch (nibble) {
+    case 0x9:
+        return 0;
+    case 0x2:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+/* Returns true if the shaft moves when shifting between the gears and the
+ * relay states (0 off, 1 reverse, 2 slow) it needs. */
+static bool shaft_relays(unsigned from_gear, unsigned to_gear, unsigned shaft, unsigned *relays) {
+    if ((to_gear == GEARBOX_NEUTRAL_GEAR) && (shaft != GEARBOX_SHAFT_REDUCER)) {
+        return false;
+    }
+    const int from = shaft_position(supported_speeds[from_gear].bitmask, shaft);
+    const int to = shaft_position(supported_speeds[to_gear].bitmask, shaft);
+    *relays = ((to > from) ? 1 : 0) | ((to == 1) ? 2 : 0);
+    return to != from;
+}
+
+/* Number of times the shared reverse and slow relays are switched when the
+ * shafts are shifted in the given order and only toggled when needed. */
+static unsigned relay_toggles(unsigned from_gear, unsigned to_gear, unsigned order) {
+    unsigned state = 0;
+    unsigned toggles = 0;
+
+    for (unsigned step = 0; step < GEARBOX_SHAFT_COUNT; ++step) {
+        unsigned relays;
+        if (shaft_relays(from_gear, to_gear, gearbox_shift_order_shaft(order, step), &relays)) {
+            toggles += ((state ^ relays) & 1) + (((state ^ relays) >> 1) & 1);
+            state = relays;
+        }
+    }
+
+    return toggles + (state & 1) + ((state >> 1) & 1);
+}
+
+void test_shift_order_is_a_permutation_of_all_shafts(void) {
+    for (unsigned from = 0; from < GEARBOX_GEAR_COUNT; ++from) {
+        for (unsigned to = 0; to < GEARBOX_GEAR_COUNT; ++to) {
+            const unsigned order = gearbox_shift_order(from, to);
+            unsigned seen = 0;
+            for (unsigned step = 0; step < GEARBOX_SHAFT_COUNT; ++step) {
+                seen |= 1u << gearbox_shift_order_shaft(order, step);
+            }
+            TEST_ASSERT_EQUAL_HEX(0x7, seen);
+            TEST_ASSERT_EQUAL(0, order >> (2 * GEARBOX_SHAFT_COUNT));
+        }
+    }
+}
+
+void test_shift_order_falls_back_to_default_for_unknown_gear(void) {
+    TEST_ASSERT_EQUAL_HEX(0x24, GEARBOX_DEFAULT_SHIFT_ORDER);
+    TEST_ASSERT_EQUAL(GEARBOX_SHAFT_INPUT, gearbox_shift_order_shaft(0x24, 0));
+    TEST_ASSERT_EQUAL(GEARBOX_SHAFT_MIDRANGE, gearbox_shift_order_shaft(0x24, 1));
+    TEST_ASSERT_EQUAL(GEARBOX_SHAFT_REDUCER, gearbox_shift_order_shaft(0x24, 2));
+    TEST_ASSERT_EQUAL(GEARBOX_DEFAULT_SHIFT_ORDER, gearbox_shift_order(GEARBOX_GEAR_INVALID, 3));
+    TEST_ASSERT_EQUAL(GEARBOX_DEFAULT_SHIFT_ORDER, gearbox_shift_order(3, GEARBOX_GEAR_COUNT));
+}
+
+void test_shift_order_never_needs_more_relay_toggles_than_default_order(void) {
+    unsigned improved = 0;
+    for (unsigned from = 0; from < GEARBOX_GEAR_COUNT; ++from) {
+        for (unsigned to = 0; to < GEARBOX_GEAR_COUNT; ++to) {
+            const unsigned planned = relay_toggles(from, to, gearbox_shift_order(from, to));
+            const unsigned fallback = relay_toggles(from, to, GEARBOX_DEFAULT_SHIFT_ORDER);
+            TEST_ASSERT_LESS_OR_EQUAL(fallback, planned);
+            improved += planned < fallback;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, improved);
+}
+
+void test_shift_order_keeps_shafts_with_equal_relay_states_together(void) {
+    /* Only consecutive shafts move at the same time */
+    for (unsigned from = 0; from < GEARBOX_GEAR_COUNT; ++from) {
+        for (unsigned to = 0; to < GEARBOX_GEAR_COUNT; ++to) {
+            const unsigned order = gearbox_shift_order(from, to);
+            unsigned relays[GEARBOX_SHAFT_COUNT];
+            unsigned moving = 0;
+            for (unsigned step = 0; step < GEARBOX_SHAFT_COUNT; ++step) {
+                moving += shaft_relays(
+                    from, to, gearbox_shift_order_shaft(order, step), &relays[moving]
+                );
+            }
+            if (moving == GEARBOX_SHAFT_COUNT) {
+                TEST_ASSERT_FALSE((relays[0] == relays[2]) && (relays[0] != relays[1]));
+            }
+        }
+    }
+}
+
+void test_shift_cost_is_zero_without_shift(void) {
+    for (unsigned gear = 0; gear < GEARBOX_GEAR_COUNT; ++gear) {
+        TEST_ASSERT_EQUAL(0, GEARBOX_SHIFT_COST_MS[gear][gear]);
+    }
+}
+
+void test_shift_cost_includes_travel_of_every_moving_shaft(void) {
+    for (unsigned from = 0; from < GEARBOX_GEAR_COUNT; ++from) {
+        for (unsigned to = 0; to < GEARBOX_GEAR_COUNT; ++to) {
+            if (from != to) {
+                /* at least one shaft moves by at least one position */
+                TEST_ASSERT_GREATER_OR_EQUAL(500, GEARBOX_SHIFT_COST_MS[from][to]);
+            }
+        }
+    }
+}
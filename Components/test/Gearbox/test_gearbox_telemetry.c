@@ -0,0 +1,61 @@
+#include "gearbox_lookup.h"
+#include "gearbox_telemetry.h"
+#include "unity.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_histogram_bucket_includes_its_upper_bound(void) {
+    TEST_ASSERT_EQUAL(0, gearbox_histogram_bucket(GEARBOX_SHIFT_TIME_BOUNDS_MS, 0));
+    TEST_ASSERT_EQUAL(0, gearbox_histogram_bucket(GEARBOX_SHIFT_TIME_BOUNDS_MS, 500));
+    TEST_ASSERT_EQUAL(1, gearbox_histogram_bucket(GEARBOX_SHIFT_TIME_BOUNDS_MS, 501));
+    TEST_ASSERT_EQUAL(6, gearbox_histogram_bucket(GEARBOX_SHIFT_TIME_BOUNDS_MS, 4000));
+}
+
+void test_histogram_bucket_counts_everything_above_the_bounds_in_the_last_bucket(void) {
+    TEST_ASSERT_EQUAL(
+        GEARBOX_HISTOGRAM_BUCKETS - 1, gearbox_histogram_bucket(GEARBOX_SHIFT_TIME_BOUNDS_MS, 4001)
+    );
+    TEST_ASSERT_EQUAL(
+        GEARBOX_HISTOGRAM_BUCKETS - 1,
+        gearbox_histogram_bucket(GEARBOX_STAGE_TIME_BOUNDS_MS, 0xFFFFFFFFu)
+    );
+}
+
+void test_histogram_bounds_are_ascending(void) {
+    for (unsigned i = 1; i < GEARBOX_HISTOGRAM_BUCKETS - 1; ++i) {
+        TEST_ASSERT_TRUE(GEARBOX_SHIFT_TIME_BOUNDS_MS[i - 1] < GEARBOX_SHIFT_TIME_BOUNDS_MS[i]);
+        TEST_ASSERT_TRUE(GEARBOX_STAGE_TIME_BOUNDS_MS[i - 1] < GEARBOX_STAGE_TIME_BOUNDS_MS[i]);
+    }
+}
+
+void test_pair_index_is_unique_for_every_shift(void) {
+    static unsigned char used[GEARBOX_PAIR_COUNT];
+
+    for (unsigned from = 0; from < GEARBOX_GEAR_COUNT; ++from) {
+        for (unsigned to = 0; to < GEARBOX_GEAR_COUNT; ++to) {
+            if (from == to) {
+                continue;
+            }
+            const unsigned index = gearbox_pair_index(from, to);
+            TEST_ASSERT_TRUE(index < GEARBOX_PAIR_COUNT);
+            TEST_ASSERT_EQUAL(0, used[index]);
+            used[index] = 1;
+        }
+    }
+}
+
+void test_pair_index_counts_shifts_from_and_to_neutral(void) {
+    TEST_ASSERT_TRUE(gearbox_pair_index(0, 1) < GEARBOX_PAIR_COUNT);
+    TEST_ASSERT_TRUE(gearbox_pair_index(GEARBOX_GEAR_COUNT - 1, 0) < GEARBOX_PAIR_COUNT);
+}
+
+void test_pair_index_is_invalid_without_a_gear_change(void) {
+    TEST_ASSERT_EQUAL(GEARBOX_PAIR_INVALID, gearbox_pair_index(3, 3));
+}
+
+void test_pair_index_is_invalid_for_an_unknown_gear(void) {
+    TEST_ASSERT_EQUAL(GEARBOX_PAIR_INVALID, gearbox_pair_index(GEARBOX_GEAR_INVALID, 3));
+    TEST_ASSERT_EQUAL(GEARBOX_PAIR_INVALID, gearbox_pair_index(3, GEARBOX_GEAR_COUNT));
+}
@@ -40,7 +40,7 @@ void test_get_target_state(void) {
 
     check_target_state(
         50.0f,
-        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_LEFT,
+        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_CENTER,
                                           TARGET_AXIS_MICROSWITCH_STATE_CENTER,
                                           TARGET_AXIS_MICROSWITCH_STATE_LEFT},
         "Low RPM falls in 80 rpm zone", &failures
@@ -56,25 +56,25 @@ void test_get_target_state(void) {
 
     check_target_state(
         500.0f,
-        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_LEFT,
-                                          TARGET_AXIS_MICROSWITCH_STATE_CENTER,
-                                          TARGET_AXIS_MICROSWITCH_STATE_RIGHT},
+        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_RIGHT,
+                                          TARGET_AXIS_MICROSWITCH_STATE_RIGHT,
+                                          TARGET_AXIS_MICROSWITCH_STATE_LEFT},
         "Exactly 500 rpm", &failures
     );
 
     check_target_state(
         1000.0f,
-        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_CENTER,
-                                          TARGET_AXIS_MICROSWITCH_STATE_RIGHT,
-                                          TARGET_AXIS_MICROSWITCH_STATE_CENTER},
+        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_RIGHT,
+                                          TARGET_AXIS_MICROSWITCH_STATE_CENTER,
+                                          TARGET_AXIS_MICROSWITCH_STATE_RIGHT},
         "Exactly 1000 rpm", &failures
     );
 
     check_target_state(
         3574.9f,
-        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_RIGHT,
-                                          TARGET_AXIS_MICROSWITCH_STATE_CENTER,
-                                          TARGET_AXIS_MICROSWITCH_STATE_LEFT},
+        (TargetGearboxMicroSwitchesState){TARGET_AXIS_MICROSWITCH_STATE_LEFT,
+                                          TARGET_AXIS_MICROSWITCH_STATE_RIGHT,
+                                          TARGET_AXIS_MICROSWITCH_STATE_RIGHT},
         "Just below max mapping", &failures
     );
 
@@ -96,3 +96,37 @@ void test_get_target_state(void) {
 
     TEST_ASSERT_EQUAL_INT_MESSAGE(0, failures, "Some gearbox target state tests failed");
 }
+
+/* Microswitches that are closed when a shaft reached the given target */
+static CurrentAxisMicroSwitchState switches_at(const TargetAxisMicroSwitchState target) {
+    switch (target) {
+        case TARGET_AXIS_MICROSWITCH_STATE_LEFT:
+            return (CurrentAxisMicroSwitchState){.left_center = true, .left = true};
+        case TARGET_AXIS_MICROSWITCH_STATE_CENTER:
+            return (CurrentAxisMicroSwitchState){.center = true};
+        default:
+            return (CurrentAxisMicroSwitchState){.right = true};
+    }
+}
+
+void test_get_target_state_matches_supported_speed_bitmasks(void) {
+    int failures = 0;
+
+    for (size_t i = 1; i < SUPPORTED_SPEEDS_COUNT; ++i) {
+        const TargetGearboxMicroSwitchesState target =
+            get_target_state((float)supported_speeds[i].rpm);
+        const GearboxMicroSwitchState reached = {
+            switches_at(target.input), switches_at(target.middle), switches_at(target.reducer)
+        };
+        const unsigned bitmask = create_bitmask_from_gearbox_state(reached);
+        if (bitmask != supported_speeds[i].bitmask) {
+            printf(
+                "FAIL: %u rpm target state gives bitmask %u, expected %u\n",
+                supported_speeds[i].rpm, bitmask, supported_speeds[i].bitmask
+            );
+            failures++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, failures, "Target states and bitmasks disagree");
+}
@@ -10,31 +10,37 @@ void tearDown(void) {}
 void test_remains_idle_when_previous_cycle_was_done_within_interval() {
     LubricationState state = {
         .state = LUBRICATION_STATE_IDLE,
-        .lubrication_start_time = 0.0f,
-        .building_pressure_start_time = 0.0f
+        .lubrication_start_time = 0,
+        .building_pressure_start_time = 0
     };
     const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = false};
 
     const LubricationConfig config = {
-        .is_enabled = true, .interval = 1, .pressure_timeout = 1.0f, .pressure_hold_time = 0
+        .enabled = true,
+        .interval = LUBRICATION_SECONDS(1),
+        .pressure_wait = LUBRICATION_SECONDS(1),
+        .hold = 0
     };
 
-    lubricate(.9f, input, &state, config);
+    lubricate(LUBRICATION_MILLISECONDS(900), input, &state, config);
     TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
 }
 
 void test_to_building_pressure_when_previous_cycle_was_too_long_ago() {
     LubricationState state = {
         .state = LUBRICATION_STATE_IDLE,
-        .lubrication_start_time = 0.0f,
-        .building_pressure_start_time = 0.0f
+        .lubrication_start_time = 0,
+        .building_pressure_start_time = 0
     };
     const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = false};
 
     const LubricationConfig config = {
-        .is_enabled = true, .interval = 1, .pressure_timeout = 1.0f, .pressure_hold_time = 0
+        .enabled = true,
+        .interval = LUBRICATION_SECONDS(1),
+        .pressure_wait = LUBRICATION_SECONDS(1),
+        .hold = 0
     };
 
-    lubricate(1.1f, input, &state, config);
+    lubricate(LUBRICATION_MILLISECONDS(1100), input, &state, config);
     TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
 }
@@ -10,16 +10,61 @@ void tearDown(void) {}
 void test_lubrication_builds_pressure_when_both_enabled(void) {
     LubricationState state = {
         .state = LUBRICATION_STATE_INITIALIZING,
-        .lubrication_start_time = 0.0f,
-        .building_pressure_start_time = 0.0f
+        .lubrication_start_time = 0,
+        .building_pressure_start_time = 0
     };
     const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = false};
 
     const LubricationConfig config = {
-        .is_enabled = true, .interval = 0, .pressure_timeout = 0, .pressure_hold_time = 0
+        .enabled = true, .interval = 0, .pressure_wait = 0, .hold = 0
     };
 
-    lubricate(0.0f, input, &state, config);
+    lubricate(0, input, &state, config);
 
     TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
 }
+
+void test_lubrication_first_cycle_waits_for_motion_enabled(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+    const LubricationSignals motion_off = {.is_motion_enabled = false, .is_pressure_ok = false};
+    const LubricationSignals motion_on = {.is_motion_enabled = true, .is_pressure_ok = false};
+
+    const LubricationConfig config = {
+        .enabled = true,
+        .interval = LUBRICATION_MINUTES(16),
+        .pressure_wait = LUBRICATION_SECONDS(60),
+        .hold = LUBRICATION_SECONDS(15)
+    };
+
+    lubricate(0, motion_off, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_DISABLED, state.state);
+
+    // Far less than an interval after the start
+    lubricate(LUBRICATION_SECONDS(10), motion_on, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+}
+
+void test_lubrication_interval_applies_after_the_first_cycle(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+    const LubricationSignals motion_off = {.is_motion_enabled = false, .is_pressure_ok = false};
+    const LubricationSignals pressure_ok = {.is_motion_enabled = true, .is_pressure_ok = true};
+
+    const LubricationConfig config = {
+        .enabled = true,
+        .interval = LUBRICATION_MINUTES(16),
+        .pressure_wait = LUBRICATION_SECONDS(60),
+        .hold = LUBRICATION_SECONDS(15)
+    };
+
+    lubricate(0, motion_off, &state, config);
+    lubricate(LUBRICATION_SECONDS(10), pressure_ok, &state, config);
+    lubricate(LUBRICATION_SECONDS(12), pressure_ok, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_LUBRICATING, state.state);
+    lubricate(LUBRICATION_SECONDS(28), pressure_ok, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
+
+    // Disabling motion again does not start another cycle
+    lubricate(LUBRICATION_SECONDS(30), motion_off, &state, config);
+    lubricate(LUBRICATION_SECONDS(40), pressure_ok, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
+}
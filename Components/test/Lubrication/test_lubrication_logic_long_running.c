@@ -0,0 +1,73 @@
+#include "lubrication_logic.h"
+#include "unity.h"
+
+#include <stdbool.h>
+
+#define STEP LUBRICATION_MILLISECONDS(100)
+#define DAY (LUBRICATION_MINUTES(60) * 24)
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_cycles_keep_their_interval_over_three_months(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+    const LubricationConfig config = {
+        .enabled = true,
+        .interval = LUBRICATION_MINUTES(16),
+        .pressure_wait = LUBRICATION_SECONDS(60),
+        .hold = LUBRICATION_SECONDS(15)
+    };
+    /* Pressure builds up in 2s, the hold time and the interval end one step
+     * after they expired */
+    const LubricationTime expected = LUBRICATION_SECONDS(2) + config.hold + STEP +
+                                     config.interval + STEP;
+    LubricationTime last_start = -1;
+    unsigned cycles = 0;
+
+    for (LubricationTime time = 0; time < 90 * DAY; time += STEP) {
+        const bool pressure_ok =
+            (state.state == LUBRICATION_STATE_BUILDING_PRESSURE) &&
+            (time - state.building_pressure_start_time >= LUBRICATION_SECONDS(2));
+        const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = pressure_ok};
+        const LubricationStates previous = state.state;
+
+        lubricate(time, input, &state, config);
+
+        if ((state.state == LUBRICATION_STATE_BUILDING_PRESSURE) &&
+            (previous != LUBRICATION_STATE_BUILDING_PRESSURE)) {
+            if (last_start >= 0) {
+                TEST_ASSERT_EQUAL_INT64(expected, time - last_start);
+            }
+            last_start = time;
+            cycles++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(90 * DAY / expected + 1, cycles);
+}
+
+void test_hold_time_has_millisecond_resolution_after_three_months(void) {
+    const LubricationTime start = 90 * DAY + LUBRICATION_MILLISECONDS(1);
+    LubricationState state = {
+        .state = LUBRICATION_STATE_LUBRICATING,
+        .lubrication_start_time = start,
+        .building_pressure_start_time = start
+    };
+    const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = true};
+    const LubricationConfig config = {
+        .enabled = true,
+        .interval = LUBRICATION_MINUTES(16),
+        .pressure_wait = LUBRICATION_SECONDS(60),
+        .hold = LUBRICATION_SECONDS(15)
+    };
+
+    lubricate(start + config.hold, input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_LUBRICATING, state.state);
+
+    lubricate(start + config.hold + LUBRICATION_MILLISECONDS(1), input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
+    TEST_ASSERT_EQUAL_INT64(
+        start + config.hold + LUBRICATION_MILLISECONDS(1), state.last_cycle_end_time
+    );
+}
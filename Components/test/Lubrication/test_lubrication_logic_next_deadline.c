@@ -0,0 +1,115 @@
+#include "lubrication_logic.h"
+#include "unity.h"
+
+#include <stdbool.h>
+
+#define STEP LUBRICATION_MILLISECONDS(100)
+#define DAY (LUBRICATION_MINUTES(60) * 24)
+
+static const LubricationConfig config = {
+    .enabled = true,
+    .interval = LUBRICATION_MINUTES(16),
+    .pressure_wait = LUBRICATION_SECONDS(60),
+    .hold = LUBRICATION_SECONDS(15)
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_idle_deadline_is_the_end_of_the_interval(void) {
+    LubricationState state = {
+        .state = LUBRICATION_STATE_IDLE, .last_cycle_end_time = LUBRICATION_SECONDS(10)
+    };
+    const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = false};
+
+    const LubricationTime deadline = lubricate(LUBRICATION_SECONDS(20), input, &state, config);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(10) + config.interval + 1, deadline);
+
+    lubricate(deadline - 1, input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
+    lubricate(deadline, input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+}
+
+void test_building_pressure_deadline_is_the_pressure_timeout(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+    const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = false};
+
+    const LubricationTime deadline = lubricate(LUBRICATION_SECONDS(1), input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(1) + config.pressure_wait + 1, deadline);
+
+    lubricate(deadline, input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_ERROR, state.state);
+}
+
+void test_building_pressure_is_due_immediately_when_pressure_is_ok(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+    const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = true};
+
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(1), lubricate(LUBRICATION_SECONDS(1), input, &state, config)
+    );
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+}
+
+void test_lubricating_deadline_is_the_end_of_the_hold_time(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_BUILDING_PRESSURE};
+    const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = true};
+
+    const LubricationTime deadline = lubricate(LUBRICATION_SECONDS(5), input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_LUBRICATING, state.state);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(5) + config.hold + 1, deadline);
+}
+
+void test_disabled_and_error_have_no_deadline(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_IDLE};
+    const LubricationSignals disabled = {.is_motion_enabled = false, .is_pressure_ok = false};
+
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_NEVER, lubricate(0, disabled, &state, config));
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_DISABLED, state.state);
+
+    state.state = LUBRICATION_STATE_ERROR;
+    const LubricationSignals enabled = {.is_motion_enabled = true, .is_pressure_ok = true};
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_NEVER, lubricate(0, enabled, &state, config));
+}
+
+/* Pressure is reached 2s after the pump started */
+static bool pressure_ok(const LubricationState *state, LubricationTime time) {
+    return (state->state == LUBRICATION_STATE_BUILDING_PRESSURE) &&
+           (time - state->building_pressure_start_time >= LUBRICATION_SECONDS(2));
+}
+
+void test_evaluating_at_deadlines_matches_evaluating_every_cycle(void) {
+    LubricationState every_cycle = {.state = LUBRICATION_STATE_INITIALIZING};
+    LubricationState at_deadline = {.state = LUBRICATION_STATE_INITIALIZING};
+    LubricationTime deadline = 0;
+    bool last_pressure = false;
+    unsigned evaluations = 0;
+    unsigned cycles = 0;
+
+    for (LubricationTime time = 0; time < 7 * DAY; time += STEP) {
+        const LubricationSignals input = {
+            .is_motion_enabled = true, .is_pressure_ok = pressure_ok(&every_cycle, time)
+        };
+        lubricate(time, input, &every_cycle, config);
+        cycles++;
+
+        /* Skip the cycle like lubrication.comp does */
+        const bool pressure = pressure_ok(&at_deadline, time);
+        if ((time >= deadline) || (pressure != last_pressure)) {
+            const LubricationSignals skipped_input = {
+                .is_motion_enabled = true, .is_pressure_ok = pressure
+            };
+            deadline = lubricate(time, skipped_input, &at_deadline, config);
+            last_pressure = pressure;
+            evaluations++;
+        }
+
+        TEST_ASSERT_EQUAL(every_cycle.state, at_deadline.state);
+    }
+
+    TEST_ASSERT_EQUAL_INT64(every_cycle.last_cycle_end_time, at_deadline.last_cycle_end_time);
+    TEST_ASSERT_LESS_THAN(cycles / 1000, evaluations);
+}
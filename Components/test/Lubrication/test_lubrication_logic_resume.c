@@ -0,0 +1,62 @@
+#include "lubrication_logic.h"
+#include "unity.h"
+
+#include <stdbool.h>
+
+static const LubricationConfig config = {
+    .enabled = true,
+    .interval = LUBRICATION_MINUTES(16),
+    .pressure_wait = LUBRICATION_SECONDS(60),
+    .hold = LUBRICATION_SECONDS(15)
+};
+
+static const LubricationSignals input = {.is_motion_enabled = true, .is_pressure_ok = false};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_resumed_schedule_continues_the_interval(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+
+    /* 10 minutes of the interval passed before the restart */
+    lubrication_resume(&state, LUBRICATION_SECONDS(1), LUBRICATION_MINUTES(10));
+    const LubricationTime deadline = lubricate(LUBRICATION_SECONDS(1), input, &state, config);
+
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(1) + LUBRICATION_MINUTES(6) + 1, deadline);
+
+    lubricate(deadline, input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+}
+
+void test_resumed_schedule_starts_a_cycle_when_the_interval_expired(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+
+    lubrication_resume(&state, LUBRICATION_SECONDS(1), LUBRICATION_MINUTES(20));
+    lubricate(LUBRICATION_SECONDS(1), input, &state, config);
+
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+}
+
+void test_resumed_schedule_waits_for_motion(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+    const LubricationSignals disabled = {.is_motion_enabled = false, .is_pressure_ok = false};
+
+    lubrication_resume(&state, LUBRICATION_SECONDS(1), LUBRICATION_MINUTES(10));
+    lubricate(LUBRICATION_SECONDS(1), disabled, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_DISABLED, state.state);
+
+    lubricate(LUBRICATION_SECONDS(2), input, &state, config);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, state.state);
+}
+
+void test_resume_has_no_effect_once_the_schedule_started(void) {
+    LubricationState state = {.state = LUBRICATION_STATE_INITIALIZING};
+
+    lubricate(LUBRICATION_SECONDS(1), input, &state, config);
+    lubrication_resume(&state, LUBRICATION_SECONDS(2), LUBRICATION_MINUTES(10));
+
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, state.state);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(1), state.building_pressure_start_time);
+}
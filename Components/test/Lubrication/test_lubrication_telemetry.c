@@ -0,0 +1,103 @@
+#include "lubrication_logic.h"
+#include "lubrication_telemetry.h"
+#include "unity.h"
+
+#include <string.h>
+
+static LubricationTelemetry telemetry;
+
+void setUp(void) { memset(&telemetry, 0, sizeof(telemetry)); }
+
+void tearDown(void) {}
+
+void test_statistics_of_the_first_cycles(void) {
+    lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(3));
+    lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(1));
+    lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(5));
+
+    TEST_ASSERT_EQUAL_UINT32(3, telemetry.total_cycles);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(5), telemetry.latest);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(1), telemetry.minimum);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(3), telemetry.mean);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(5), telemetry.maximum);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(1), telemetry.trend);
+}
+
+void test_single_cycle_has_no_trend(void) {
+    lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(2));
+
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(2), telemetry.mean);
+    TEST_ASSERT_EQUAL_INT64(0, telemetry.trend);
+}
+
+void test_old_cycles_leave_the_window(void) {
+    lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(30));
+    for (unsigned i = 0; i < LUBRICATION_TELEMETRY_WINDOW; i++) {
+        lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(2));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(LUBRICATION_TELEMETRY_WINDOW + 1, telemetry.total_cycles);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(2), telemetry.minimum);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(2), telemetry.mean);
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_SECONDS(2), telemetry.maximum);
+    TEST_ASSERT_EQUAL_INT64(0, telemetry.trend);
+}
+
+void test_trend_follows_a_wearing_pump_after_the_window_wrapped(void) {
+    /* the time-to-pressure rises by 250 ms per cycle */
+    for (unsigned i = 0; i < 3 * LUBRICATION_TELEMETRY_WINDOW; i++) {
+        lubrication_telemetry_record(
+            &telemetry, LUBRICATION_SECONDS(2) + i * LUBRICATION_MILLISECONDS(250)
+        );
+    }
+
+    TEST_ASSERT_EQUAL_INT64(LUBRICATION_MILLISECONDS(250), telemetry.trend);
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(2) + 32 * LUBRICATION_MILLISECONDS(250), telemetry.minimum
+    );
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(2) + 47 * LUBRICATION_MILLISECONDS(250), telemetry.maximum
+    );
+}
+
+void test_trend_is_negative_when_the_pressure_builds_faster(void) {
+    for (unsigned i = 0; i < 4; i++) {
+        lubrication_telemetry_record(&telemetry, LUBRICATION_SECONDS(10 - i));
+    }
+
+    TEST_ASSERT_EQUAL_INT64(-LUBRICATION_SECONDS(1), telemetry.trend);
+}
+
+void test_adaptive_hold_is_a_multiple_of_the_time_to_pressure(void) {
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(6),
+        lubrication_adaptive_hold(
+            LUBRICATION_SECONDS(2), LUBRICATION_SECONDS(15), LUBRICATION_SECONDS(5), 300
+        )
+    );
+}
+
+void test_adaptive_hold_never_exceeds_the_configured_hold(void) {
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(15),
+        lubrication_adaptive_hold(
+            LUBRICATION_SECONDS(10), LUBRICATION_SECONDS(15), LUBRICATION_SECONDS(5), 300
+        )
+    );
+}
+
+void test_adaptive_hold_keeps_the_minimum(void) {
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(5),
+        lubrication_adaptive_hold(
+            LUBRICATION_MILLISECONDS(500), LUBRICATION_SECONDS(15), LUBRICATION_SECONDS(5), 300
+        )
+    );
+    /* a minimum above the configured hold is limited to the configured hold */
+    TEST_ASSERT_EQUAL_INT64(
+        LUBRICATION_SECONDS(4),
+        lubrication_adaptive_hold(
+            LUBRICATION_MILLISECONDS(500), LUBRICATION_SECONDS(4), LUBRICATION_SECONDS(5), 300
+        )
+    );
+}
@@ -0,0 +1,181 @@
+#include "lubrication_logic.h"
+#include "maintenance_scheduler.h"
+#include "unity.h"
+
+#include <stdbool.h>
+
+static MaintenanceScheduler scheduler;
+
+static LubricationConfig task_config(unsigned interval_minutes) {
+    const LubricationConfig config = {
+        .enabled = true,
+        .interval = LUBRICATION_MINUTES(interval_minutes),
+        .pressure_wait = LUBRICATION_SECONDS(60),
+        .hold = LUBRICATION_SECONDS(15)
+    };
+    return config;
+}
+
+/* Evaluate every due task like maintenance.comp does, returns the number of
+ * evaluated tasks */
+static unsigned run(LubricationTime time, bool is_confirmed) {
+    unsigned task;
+    unsigned evaluated = 0;
+
+    while (maintenance_next_due(&scheduler, time, &task)) {
+        maintenance_evaluate(&scheduler, task, time, is_confirmed);
+        evaluated++;
+    }
+    return evaluated;
+}
+
+/* Wake the tasks waiting for their confirmation like maintenance.comp does
+ * when their confirm input is set */
+static void confirm_waiting(LubricationTime time) {
+    for (unsigned task = 0; task < scheduler.task_count; task++) {
+        if (scheduler.awaiting_confirmation & (1u << task)) {
+            maintenance_wake(&scheduler, task, time);
+        }
+    }
+}
+
+/* Run a full cycle of every task, all of them are idle afterwards */
+static void complete_first_cycles(unsigned task_count) {
+    run(LUBRICATION_SECONDS(1), false);
+    confirm_waiting(LUBRICATION_SECONDS(2));
+    run(LUBRICATION_SECONDS(2), true);
+    run(LUBRICATION_SECONDS(20), true);
+    for (unsigned task = 0; task < task_count; task++) {
+        TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, scheduler.tasks[task].cycle.state);
+    }
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_all_tasks_start_with_a_cycle(void) {
+    maintenance_init(&scheduler, 3);
+    for (unsigned task = 0; task < 3; task++) {
+        maintenance_configure(&scheduler, task, 0, task_config(16));
+    }
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+
+    TEST_ASSERT_EQUAL_UINT(3, run(LUBRICATION_SECONDS(1), false));
+    for (unsigned task = 0; task < 3; task++) {
+        TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, scheduler.tasks[task].cycle.state);
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x7, scheduler.awaiting_confirmation);
+}
+
+void test_nothing_is_due_before_the_earliest_deadline(void) {
+    maintenance_init(&scheduler, 3);
+    maintenance_configure(&scheduler, 0, 0, task_config(30));
+    maintenance_configure(&scheduler, 1, 0, task_config(10));
+    maintenance_configure(&scheduler, 2, 0, task_config(20));
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+    complete_first_cycles(3);
+    TEST_ASSERT_EQUAL_HEX32(0, scheduler.awaiting_confirmation);
+
+    TEST_ASSERT_EQUAL_UINT(0, run(LUBRICATION_SECONDS(20) + LUBRICATION_MINUTES(10), false));
+
+    const LubricationTime deadline = LUBRICATION_SECONDS(20) + LUBRICATION_MINUTES(10) + 1;
+    unsigned task = 99;
+    TEST_ASSERT_TRUE(maintenance_next_due(&scheduler, deadline, &task));
+    TEST_ASSERT_EQUAL_UINT(1, task);
+}
+
+void test_tasks_become_due_in_deadline_order(void) {
+    /* none of the tasks is due a second time within the longest interval */
+    static const unsigned intervals[MAINTENANCE_MAX_TASKS] = {
+        25, 19, 30, 17, 28, 23, 32, 18, 27, 21, 31, 20, 26, 29, 22, 24
+    };
+
+    maintenance_init(&scheduler, MAINTENANCE_MAX_TASKS);
+    for (unsigned task = 0; task < MAINTENANCE_MAX_TASKS; task++) {
+        maintenance_configure(&scheduler, task, 0, task_config(intervals[task]));
+    }
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+    complete_first_cycles(MAINTENANCE_MAX_TASKS);
+
+    for (unsigned minutes = 17; minutes <= 32; minutes++) {
+        const LubricationTime time = LUBRICATION_SECONDS(20) + LUBRICATION_MINUTES(minutes) + 1;
+        unsigned task;
+
+        TEST_ASSERT_TRUE(maintenance_next_due(&scheduler, time, &task));
+        TEST_ASSERT_EQUAL_UINT(minutes, intervals[task]);
+        TEST_ASSERT_EQUAL_UINT(1, run(time, false));
+        TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, scheduler.tasks[task].cycle.state);
+
+        /* finish the cycle before the next task is due */
+        confirm_waiting(time);
+        run(time, true);
+        run(time + LUBRICATION_SECONDS(16), true);
+        TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, scheduler.tasks[task].cycle.state);
+    }
+}
+
+void test_woken_task_is_due_right_away(void) {
+    maintenance_init(&scheduler, 2);
+    maintenance_configure(&scheduler, 0, 0, task_config(16));
+    maintenance_configure(&scheduler, 1, 0, task_config(16));
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+    run(LUBRICATION_SECONDS(1), false);
+
+    TEST_ASSERT_EQUAL_UINT(0, run(LUBRICATION_SECONDS(2), true));
+
+    /* the confirmation input of task 1 changed */
+    maintenance_wake(&scheduler, 1, LUBRICATION_SECONDS(2));
+    TEST_ASSERT_EQUAL_UINT(1, run(LUBRICATION_SECONDS(2), true));
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, scheduler.tasks[0].cycle.state);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_LUBRICATING, scheduler.tasks[1].cycle.state);
+    TEST_ASSERT_EQUAL_HEX32(0x1, scheduler.awaiting_confirmation);
+}
+
+void test_only_a_changed_config_wakes_a_task(void) {
+    maintenance_init(&scheduler, 2);
+    maintenance_configure(&scheduler, 0, 0, task_config(16));
+    maintenance_configure(&scheduler, 1, 0, task_config(16));
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+    complete_first_cycles(2);
+
+    const LubricationTime time = LUBRICATION_MINUTES(5);
+    maintenance_configure(&scheduler, 0, time, task_config(16));
+    TEST_ASSERT_EQUAL_UINT(0, run(time, false));
+
+    /* a shorter interval that already expired starts a cycle */
+    maintenance_configure(&scheduler, 0, time, task_config(4));
+    TEST_ASSERT_EQUAL_UINT(1, run(time, false));
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, scheduler.tasks[0].cycle.state);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_IDLE, scheduler.tasks[1].cycle.state);
+}
+
+void test_motion_disabled_disables_all_tasks(void) {
+    maintenance_init(&scheduler, 2);
+    maintenance_configure(&scheduler, 0, 0, task_config(16));
+    maintenance_configure(&scheduler, 1, 0, task_config(16));
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+    complete_first_cycles(2);
+
+    maintenance_set_motion_enabled(&scheduler, LUBRICATION_MINUTES(1), false);
+    TEST_ASSERT_EQUAL_UINT(2, run(LUBRICATION_MINUTES(1), false));
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_DISABLED, scheduler.tasks[0].cycle.state);
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_DISABLED, scheduler.tasks[1].cycle.state);
+
+    /* without motion nothing becomes due, however long it takes */
+    TEST_ASSERT_EQUAL_UINT(0, run(LUBRICATION_MINUTES(60 * 24), false));
+
+    maintenance_set_motion_enabled(&scheduler, LUBRICATION_MINUTES(60 * 24), true);
+    TEST_ASSERT_EQUAL_UINT(2, run(LUBRICATION_MINUTES(60 * 24), false));
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_BUILDING_PRESSURE, scheduler.tasks[0].cycle.state);
+}
+
+void test_confirmation_present_at_the_start_proceeds_right_away(void) {
+    maintenance_init(&scheduler, 1);
+    maintenance_configure(&scheduler, 0, 0, task_config(16));
+    maintenance_set_motion_enabled(&scheduler, 0, true);
+
+    TEST_ASSERT_EQUAL_UINT(1, run(LUBRICATION_SECONDS(1), true));
+    TEST_ASSERT_EQUAL(LUBRICATION_STATE_LUBRICATING, scheduler.tasks[0].cycle.state);
+    TEST_ASSERT_EQUAL_HEX32(0, scheduler.awaiting_confirmation);
+}
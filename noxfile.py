@@ -6,6 +6,22 @@ import nox
 
 EN_CORE_WEB_SM_VERSION = "3.8.0"
 
+BENCHMARKS = {
+    "bench_gear_lookup": [
+        "Components/bench/Gearbox/bench_gear_lookup.c",
+        "Components/src/Gearbox/gearbox_logic.c",
+    ],
+    "bench_lubricate_deadline": [
+        "Components/bench/Lubrication/bench_lubricate_deadline.c",
+        "Components/src/Lubrication/lubrication_logic.c",
+    ],
+    "bench_maintenance_scheduler": [
+        "Components/bench/Lubrication/bench_maintenance_scheduler.c",
+        "Components/src/Lubrication/maintenance_scheduler.c",
+        "Components/src/Lubrication/lubrication_logic.c",
+    ],
+}
+
 
 @nox.session
 def build_test(session: nox.Session) -> None:
@@ -17,6 +33,7 @@ def build_test(session: nox.Session) -> None:
 
     `ceedling build` is called because its build creates the unity.h and cmock.h headers.
     """
+    check_gearbox_tables(session)
     session.run(
         "cmake",
         "-B", "cmake-build-test",
@@ -59,15 +76,98 @@ def test(session: nox.Session) -> None:
     A separate CMake build is not required for running these tests,
     as Ceedling manages its own build and test process.
     """
+    check_gearbox_tables(session)
     session.chdir("Components")
     session.run("ceedling", "test", external=True)
 
 
+@nox.session
+def bench(session: nox.Session) -> None:
+    """Build and run the microbenchmarks in Components/bench.
+
+    Each benchmark is a standalone program that is linked against the logic
+    sources it measures, optimized the same way as the components.
+    """
+    build_path = pathlib.Path("Components") / "build" / "bench"
+    build_path.mkdir(parents=True, exist_ok=True)
+
+    for name, sources in BENCHMARKS.items():
+        executable = str(build_path / name)
+        session.run(
+            "cc", "-std=c11", "-O2", "-Wall",
+            "-I", "Components/src/Gearbox",
+            "-I", "Components/src/Lubrication",
+            *sources,
+            "-lm",
+            "-o", executable,
+            external=True
+        )
+        session.run(executable, external=True)
+
+
+@nox.session
+def replay(session: nox.Session) -> None:
+    """Replay a trace of mh400e_gearbox_trace against the current gearbox component.
+
+    The component is translated to plain C by tools/hal/host_comp.py and built
+    against the rtapi/HAL replacements in Components/host. Pass the trace file
+    and the options of gearbox_replay after `--`, e.g.
+    `nox -s replay -- gearbox.trace --set twitch-pulse-ms=600`.
+    """
+    build_path = pathlib.Path("Components") / "build" / "replay"
+    build_path.mkdir(parents=True, exist_ok=True)
+
+    session.run(
+        "python3", "tools/hal/host_comp.py",
+        "Components/src/Gearbox/mh400e_gearbox.comp",
+        str(build_path / "mh400e_gearbox_host.c"),
+        external=True
+    )
+    executable = str(build_path / "gearbox_replay")
+    session.run(
+        "cc", "-std=gnu11", "-O2",
+        "-I", "Components/host",
+        "-I", "Components/src/Gearbox",
+        "-I", "Components/src/Common",
+        "-I", str(build_path),
+        "Components/replay/Gearbox/gearbox_replay.c",
+        str(build_path / "mh400e_gearbox_host.c"),
+        "Components/host/hal_host.c",
+        "-lm",
+        "-o", executable,
+        external=True
+    )
+    if session.posargs:
+        session.run(executable, *session.posargs, external=True)
+
+
+@nox.session
+def generate_gearbox_tables(session: nox.Session) -> None:
+    """Regenerate the static gearbox lookup tables in Components/src/Gearbox/gearbox_tables.h
+
+    The tables are generated from Components/src/Gearbox/gearbox_gears.txt. The generated
+    header is committed, so that halcompile can build the gearbox component without this step.
+    """
+    session.run("python3", "tools/gearbox/generate_gearbox_tables.py", external=True)
+
+
+def check_gearbox_tables(session: nox.Session) -> None:
+    """Fail if Components/src/Gearbox/gearbox_tables.h does not match gearbox_gears.txt."""
+    session.run("python3", "tools/gearbox/generate_gearbox_tables.py", "--check", external=True)
+
+
 @nox.session
 def install_components(session: nox.Session) -> None:
     """Install all linuxcnc components"""
     session.run("sudo", "halcompile", "--install", "Components/src/Lubrication/lubrication.comp", external=True)
     session.run("sudo", "halcompile", "--install-doc", "Components/src/Lubrication/lubrication.comp", external=True)
+    session.run("sudo", "halcompile", "--install", "Components/src/Lubrication/maintenance.comp", external=True)
+    session.run("sudo", "halcompile", "--install-doc", "Components/src/Lubrication/maintenance.comp", external=True)
+    session.run(
+        "sudo", "install", "-m", "755",
+        "Components/src/Lubrication/lubrication_persist.py", "/usr/local/bin/lubrication_persist",
+        external=True
+    )
 
 
 @nox.session
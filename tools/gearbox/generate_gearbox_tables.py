@@ -0,0 +1,352 @@
+"""Generate the static lookup tables used by the gearbox logic.
+
+All tables are derived from the gear definitions in
+Components/src/Gearbox/gearbox_gears.txt, so that the gearbox logic and the
+mh400e_gearbox component can not drift apart and nothing has to be computed,
+sorted or allocated at runtime.
+
+The MH400E reports its gear as a 12 bit microswitch bitmask (4 bits for each
+of the input, midrange and reducer shafts). Instead of searching the list of
+supported speeds on every servo cycle, every possible bitmask is mapped to
+its gear index ahead of time.
+
+Requested spindle speeds are quantized to the closest supported speed using a
+small sorted array of decision thresholds, so that the lookup is a fixed
+number of compares.
+
+For every pair of current and target gear the shaft order with the lowest
+estimated shift time is planned ahead of time as well, see `shift_cost()`.
+
+Run `nox -s generate_gearbox_tables` after changing the gear definitions,
+`--check` only verifies that the generated header is up to date.
+"""
+
+import argparse
+import itertools
+import pathlib
+import sys
+from typing import NamedTuple
+
+GEARBOX_PATH = pathlib.Path(__file__).parents[2] / "Components" / "src" / "Gearbox"
+DEFINITIONS = GEARBOX_PATH / "gearbox_gears.txt"
+OUTPUT = GEARBOX_PATH / "gearbox_tables.h"
+
+NEUTRAL_GEAR_INDEX = 0
+BITMASK_COUNT = 1 << 12
+SHAFT_MASK = 0x00F
+GEAR_INVALID = 0xFF
+
+# Microswitch bits of a single shaft for each position, "-" means that the
+# position of the shaft does not matter for the gear.
+POSITION_BITS = {"left": 0b1001, "center": 0b0100, "right": 0b0010, "-": 0b0000}
+
+# Values of TargetAxisMicroSwitchState, shafts that do not matter are kept in
+# the center.
+POSITION_TARGETS = {"left": 0, "center": 1, "right": 2, "-": 1}
+
+# The threshold array is padded to a power of two so that the binary search
+# always takes the same number of steps, 32 unsigned shorts fill one cache line.
+RPM_THRESHOLD_COUNT = 32
+RPM_THRESHOLD_PADDING = 0xFFFF
+
+
+# Shafts as numbered in the packed shift orders (see gearbox_lookup.h), the
+# default order is the order in which the component used to shift.
+SHAFTS = ("input", "midrange", "reducer")
+DEFAULT_SHIFT_ORDER = (0, 1, 2)
+
+# Cost model of a gear shift in milliseconds. The relay intervals match
+# MH400E_REVERSE_MOTOR_INTERVAL, MH400E_SLOW_MOTOR_INTERVAL and
+# MH400E_GENERIC_PIN_INTERVAL in mh400e_common.h, the travel times per
+# position are rough estimates, they are the same for every shaft order and
+# only make the total a usable estimate of the shift duration.
+REVERSE_RELAY_MS = 100
+SLOW_RELAY_MS = 5
+MOTOR_OFF_MS = 100
+RELAYS_OFF_MS = 100
+FAST_TRAVEL_MS = 500
+SLOW_TRAVEL_MS = 1000
+
+# Position index from left (furthest CCW, "red") to right (furthest CW, "yellow"),
+# see MH400E_STAGE_POS_* in mh400e_common.h.
+POSITION_INDEX = {"left": 0, "center": 1, "right": 2}
+
+
+class Gear(NamedTuple):
+    rpm: int
+    input: str
+    midrange: str
+    reducer: str
+
+    @property
+    def bitmask(self) -> int:
+        return (
+            POSITION_BITS[self.input] << 8
+            | POSITION_BITS[self.midrange] << 4
+            | POSITION_BITS[self.reducer]
+        )
+
+
+def read_gears(path: pathlib.Path) -> list[Gear]:
+    gears = []
+    for number, line in enumerate(path.read_text().splitlines(), start=1):
+        line = line.split("#", 1)[0].strip()
+        if not line:
+            continue
+
+        columns = line.split()
+        if len(columns) != 4 or any(c not in POSITION_BITS for c in columns[1:]):
+            sys.exit(f"{path}:{number}: expected 'rpm input midrange reducer', got '{line}'")
+        gears.append(Gear(int(columns[0]), *columns[1:]))
+
+    if not gears or gears[NEUTRAL_GEAR_INDEX].rpm != 0:
+        sys.exit(f"{path}: the first gear must be neutral with 0 rpm")
+    if [gear.rpm for gear in gears] != sorted(set(gear.rpm for gear in gears)):
+        sys.exit(f"{path}: gears must be sorted by rpm without duplicates")
+    if len(gears) >= GEAR_INVALID:
+        sys.exit(f"{path}: too many gears")
+    return gears
+
+
+def gear_by_bitmask(gears: list[Gear]) -> list[int]:
+    """Map every 12 bit microswitch bitmask to a gear index.
+
+    Neutral only depends on the reducer shaft being centered, the position of
+    the other two shafts does not matter, so all 256 bitmasks with the neutral
+    reducer bits are explicit neutral entries.
+    """
+    neutral_reducer = gears[NEUTRAL_GEAR_INDEX].bitmask & SHAFT_MASK
+    table = [GEAR_INVALID] * BITMASK_COUNT
+
+    for bitmask in range(BITMASK_COUNT):
+        if bitmask & SHAFT_MASK == neutral_reducer:
+            table[bitmask] = NEUTRAL_GEAR_INDEX
+
+    for index, gear in enumerate(gears):
+        if index != NEUTRAL_GEAR_INDEX:
+            if table[gear.bitmask] != GEAR_INVALID:
+                sys.exit(f"{DEFINITIONS}: {gear.rpm} rpm has the same bitmask as another gear")
+            table[gear.bitmask] = index
+
+    return table
+
+
+def rpm_thresholds(gears: list[Gear]) -> list[int]:
+    """Decision thresholds between neighbouring speeds, excluding neutral.
+
+    Each threshold is the midpoint between two speeds multiplied by two, which
+    keeps it an integer. A requested speed selects the higher gear when twice
+    its value is at least the threshold, so ties are rounded up.
+    """
+    speeds = [gear.rpm for index, gear in enumerate(gears) if index != NEUTRAL_GEAR_INDEX]
+
+    thresholds = [low + high for low, high in zip(speeds, speeds[1:])]
+    assert len(thresholds) < RPM_THRESHOLD_COUNT
+    assert max(thresholds) < RPM_THRESHOLD_PADDING
+    return thresholds + [RPM_THRESHOLD_PADDING] * (RPM_THRESHOLD_COUNT - len(thresholds))
+
+
+def shaft_move(current: str, target: str) -> tuple[int, bool, bool] | None:
+    """Distance, reverse and slow relay state needed to move a shaft.
+
+    Shafts that do not matter for the current gear are assumed to be in the
+    center, shafts that do not matter for the target gear are not moved.
+    Moving to the right needs the reverse relay (CCW) and the center position
+    is approached slowly, the same rules as gearshift_need_reverse().
+    """
+    if target == "-":
+        return None
+    current = "center" if current == "-" else current
+    distance = POSITION_INDEX[target] - POSITION_INDEX[current]
+    if distance == 0:
+        return None
+    return abs(distance), distance > 0, target == "center"
+
+
+def shift_cost(current: Gear, target: Gear, order: tuple[int, ...]) -> int:
+    """Estimated duration of a shift when the shafts are moved in the given order.
+
+    The reverse and slow relays are shared by all shaft motors. The component
+    leaves them as they are between two shafts and only toggles them when the
+    next shaft needs a different state, at the end of the shift both are
+    turned off together. Consecutive shafts that need the same relay states
+    move at the same time (the default `concurrent-shift` mode). The order
+    therefore decides how many relay toggles (each followed by a wait) are
+    needed and which shafts move together.
+    """
+    groups: list[tuple[bool, bool, int]] = []  # reverse, slow, longest travel
+    for shaft in order:
+        move = shaft_move(getattr(current, SHAFTS[shaft]), getattr(target, SHAFTS[shaft]))
+        if move is None:
+            continue
+
+        distance, needs_reverse, needs_slow = move
+        travel = distance * (SLOW_TRAVEL_MS if needs_slow else FAST_TRAVEL_MS)
+        if groups and groups[-1][:2] == (needs_reverse, needs_slow):
+            groups[-1] = (needs_reverse, needs_slow, max(groups[-1][2], travel))
+        else:
+            groups.append((needs_reverse, needs_slow, travel))
+
+    reverse, slow = False, False
+    cost = 0
+    for needs_reverse, needs_slow, travel in groups:
+        if reverse != needs_reverse:
+            reverse = needs_reverse
+            cost += REVERSE_RELAY_MS
+        if slow != needs_slow:
+            slow = needs_slow
+            cost += SLOW_RELAY_MS
+        cost += travel + MOTOR_OFF_MS
+
+    return cost + (RELAYS_OFF_MS if reverse or slow else 0)
+
+
+def shift_plans(gears: list[Gear]) -> tuple[list[list[int]], list[list[int]]]:
+    """Fastest shaft order and its estimated duration for every pair of gears.
+
+    Orders are packed into one byte, two bits per shaft, first shaft in the
+    lowest bits. On equal cost the default order is kept.
+    """
+    # min() keeps the first of equally good orders, the default order comes first
+    orders = sorted(itertools.permutations(range(len(SHAFTS))), key=lambda o: o != DEFAULT_SHIFT_ORDER)
+    packed = [[0] * len(gears) for _ in gears]
+    costs = [[0] * len(gears) for _ in gears]
+
+    for i, current in enumerate(gears):
+        for j, target in enumerate(gears):
+            best = min(orders, key=lambda order: shift_cost(current, target, order))
+            packed[i][j] = pack_order(best)
+            costs[i][j] = shift_cost(current, target, best)
+
+    return packed, costs
+
+
+def pack_order(order: tuple[int, ...]) -> int:
+    return sum(shaft << (2 * step) for step, shaft in enumerate(order))
+
+
+def render_matrix(ctype: str, name: str, rows: list[list[int]], fmt: str) -> str:
+    lines = ["// clang-format off",
+             f"static const {ctype} {name}[{len(rows)}][{len(rows[0])}] = {{"]
+    for row in rows:
+        lines.append("    {" + ", ".join(format(value, fmt) for value in row) + "},")
+    lines[-1] = lines[-1].rstrip(",")
+    lines += ["};", "// clang-format on"]
+    return "\n".join(lines)
+
+
+def render_speed_pairs(gears: list[Gear]) -> str:
+    lines = ["/* {rpm, bitmask} initializer for every gear, ordered by gear index */",
+             "#define GEARBOX_SPEED_PAIRS \\"]
+    for index, gear in enumerate(gears):
+        separator = ", \\" if index < len(gears) - 1 else ""
+        lines.append(f"    {{{gear.rpm}, {gear.bitmask}}}{separator}")
+    return "\n".join(lines)
+
+
+def render_target_positions(gears: list[Gear]) -> str:
+    lines = ["// clang-format off",
+             f"static const unsigned char GEARBOX_TARGET_POSITIONS[{len(gears)}][3] = {{"]
+    for gear in gears:
+        targets = ", ".join(str(POSITION_TARGETS[p]) for p in (gear.input, gear.midrange, gear.reducer))
+        lines.append(f"    {{{targets}}}, /* {gear.rpm:4d} rpm */")
+    lines[-1] = lines[-1].replace("},", "} ", 1)
+    lines += ["};", "// clang-format on"]
+    return "\n".join(lines)
+
+
+def render_short_table(name: str, values: list[int], per_line: int = 8) -> str:
+    lines = [f"static const unsigned short {name}[{len(values)}] = {{"]
+    for offset in range(0, len(values), per_line):
+        row = ", ".join(f"{value:5d}" for value in values[offset:offset + per_line])
+        lines.append(f"    {row},")
+    lines[-1] = lines[-1].rstrip(",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def render_byte_table(name: str, values: list[int], per_line: int = 16) -> str:
+    lines = ["// clang-format off", f"static const unsigned char {name}[{len(values)}] = {{"]
+    for offset in range(0, len(values), per_line):
+        row = ", ".join(f"0x{value:02x}" for value in values[offset:offset + per_line])
+        lines.append(f"    /* 0x{offset:03x} */ {row},")
+    lines[-1] = lines[-1].rstrip(",")
+    lines.append("};")
+    lines.append("// clang-format on")
+    return "\n".join(lines)
+
+
+def render(gears: list[Gear]) -> str:
+    orders, costs = shift_plans(gears)
+    return "\n".join([
+        "/* Generated by tools/gearbox/generate_gearbox_tables.py from gearbox_gears.txt,",
+        " * do not edit. */",
+        "",
+        "#ifndef GEARBOX_TABLES_H",
+        "#define GEARBOX_TABLES_H",
+        "",
+        "/* Number of gears including neutral */",
+        f"#define GEARBOX_GEAR_COUNT {len(gears)}",
+        "",
+        render_speed_pairs(gears),
+        "",
+        "/* Gear index -> spindle speed in rpm */",
+        render_short_table("GEARBOX_GEAR_RPM", [gear.rpm for gear in gears]),
+        "",
+        "/* Gear index -> target position of the input, midrange and reducer shafts,",
+        " * 0 is left, 1 is center and 2 is right (see TargetAxisMicroSwitchState).",
+        " * Shafts whose position does not matter are kept in the center. */",
+        render_target_positions(gears),
+        "",
+        "/* 12 bit microswitch bitmask -> gear index.",
+        f" * Bitmasks that do not describe a gear map to 0x{GEAR_INVALID:02x} (GEARBOX_GEAR_INVALID). */",
+        render_byte_table("GEARBOX_GEAR_BY_BITMASK", gear_by_bitmask(gears)),
+        "",
+        "/* Highest supported spindle speed */",
+        f"#define GEARBOX_MAX_RPM {gears[-1].rpm}",
+        "",
+        "/* Twice the midpoint between each pair of neighbouring speeds (neutral excluded),",
+        f" * padded with 0x{RPM_THRESHOLD_PADDING:x} to a power of two for a fixed step binary search. */",
+        render_short_table("GEARBOX_RPM_THRESHOLDS", rpm_thresholds(gears)),
+        "",
+        "/* Shaft order used when the current gear is unknown */",
+        f"#define GEARBOX_DEFAULT_SHIFT_ORDER 0x{pack_order(DEFAULT_SHIFT_ORDER):02x}",
+        "",
+        "/* [current gear][target gear] -> order in which the shafts are shifted, two bits",
+        " * per shaft (0 input, 1 midrange, 2 reducer), the first shaft in the lowest bits.",
+        " * Minimizes the estimated shift duration in GEARBOX_SHIFT_COST_MS. */",
+        render_matrix("unsigned char", "GEARBOX_SHIFT_ORDER", orders, "#04x"),
+        "",
+        "/* [current gear][target gear] -> estimated shift duration in milliseconds, only",
+        " * the tests read it, TEST is defined for the Ceedling builds */",
+        "#ifdef TEST",
+        render_matrix("unsigned short", "GEARBOX_SHIFT_COST_MS", costs, "5d"),
+        "#endif // TEST",
+        "",
+        "#endif // GEARBOX_TABLES_H",
+        "",
+    ])
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=f"Generate {OUTPUT.name} from {DEFINITIONS.name}.")
+    parser.add_argument(
+        "--check",
+        action="store_true",
+        help="only verify that the committed header is up to date, do not write it",
+    )
+    args = parser.parse_args()
+
+    content = render(read_gears(DEFINITIONS))
+
+    if args.check:
+        if not OUTPUT.exists() or OUTPUT.read_text() != content:
+            sys.exit(f"{OUTPUT} is out of date, run `nox -s generate_gearbox_tables`")
+        return
+
+    OUTPUT.write_text(content)
+    print(f"Wrote {OUTPUT}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,285 @@
+"""Translate a realtime halcompile component into plain C for the host.
+
+The generated source contains the C part of the component unchanged, with the
+pin, param and variable macros and the FUNCTION/EXTRA_SETUP/EXTRA_CLEANUP
+macros defined the way halcompile defines them. It builds against the rtapi.h
+and hal.h replacements in Components/host, so the component logic runs in an
+ordinary program without LinuxCNC, e.g. the trace replay of mh400e_gearbox.
+
+For a component `name` the generated header declares:
+
+- `name_host_new(prefix, personality)` creates a zeroed instance, runs
+  EXTRA_SETUP and then allocates the pins and applies the defaults, in the
+  order of halcompile, so EXTRA_SETUP sees no pins and zero params,
+- `name_host_run(inst, period)` for `function _` and `name_host_FUNCT(inst,
+  period)` for every other function,
+- `name_host_pin(inst, "hal-name")` returns the address of a pin pointer, a
+  program nets two pins by pointing both at the same value,
+- `name_host_param(inst, "hal-name")` returns the address of a param value,
+  `name_host_set_param(inst, "hal-name", value)` converts and sets it,
+- `name_host_set_pin(inst, "hal-name", value)` converts and sets the value of
+  an input pin, e.g. for the loop program,
+- `name_host_cleanup()` if the component has EXTRA_CLEANUP.
+
+Only the subset of the halcompile language used in this repository is
+supported, userspace components are rejected.
+
+Usage: host_comp.py COMPONENT.comp OUTPUT.c [OUTPUT.h]
+"""
+
+import pathlib
+import re
+import sys
+from typing import NamedTuple
+
+C_TYPES = {"bit": "hal_bit_t", "float": "hal_float_t", "u32": "hal_u32_t", "s32": "hal_s32_t"}
+
+
+class Item(NamedTuple):
+    """A pin or param of the component."""
+
+    kind: str  # "pin" or "param"
+    direction: str
+    type: str
+    name: str  # as written in the component, e.g. "shift_time_hist-#"
+    size: int  # 0 for scalars
+    default: str | None
+
+    @property
+    def c_name(self) -> str:
+        return self.name.replace("#", "").replace("-", "_").rstrip("_")
+
+    def hal_names(self) -> list[str]:
+        """HAL names of the item, one per array element."""
+        name = self.name.replace("_", "-")
+        if not self.size:
+            return [name.rstrip("-")]
+        width = name.count("#")
+        return [re.sub("#+", f"{i:0{width}d}", name) for i in range(self.size)]
+
+
+class Variable(NamedTuple):
+    type: str
+    name: str
+    array: str
+    default: str | None
+
+
+class Component(NamedTuple):
+    name: str
+    items: list[Item]
+    variables: list[Variable]
+    functions: list[str]
+    options: dict[str, str]
+    includes: list[str]
+    body: str
+    body_line: int
+
+
+def strip_documentation(declarations: str) -> str:
+    """Remove comments and documentation strings, they may contain semicolons."""
+    declarations = re.sub(r'"""(.*?)"""', '""', declarations, flags=re.S)
+    declarations = re.sub(r"/\*.*?\*/", "", declarations, flags=re.S)
+    declarations = re.sub(r"//[^\n]*", "", declarations)
+    return re.sub(r'"(?:[^"\\]|\\.)*"', '""', declarations)
+
+
+def parse(path: pathlib.Path) -> Component:
+    source = path.read_text()
+    declarations, separator, body = source.partition("\n;;\n")
+    if not separator:
+        sys.exit(f"{path}: missing the ;; that separates the declarations from the C code")
+
+    name = None
+    items = []
+    variables = []
+    functions = []
+    options = {}
+    includes = []
+
+    for statement in strip_documentation(declarations).split(";"):
+        statement = " ".join(statement.split())
+        if not statement:
+            continue
+        keyword = statement.split()[0]
+
+        if keyword == "component":
+            name = statement.split()[1]
+        elif keyword in ("pin", "param"):
+            match = re.match(
+                r"(pin|param) (\w+) (\w+) ([\w#-]+) ?(?:\[ ?(\d+) ?(?::[^\]]*)?\])? ?(?:= ?([^\"]+?))? ?(?:\"\")?$",
+                statement,
+            )
+            if match is None:
+                sys.exit(f"{path}: can not parse '{statement}'")
+            kind, direction, type_, item_name, size, default = match.groups()
+            if type_ not in C_TYPES:
+                sys.exit(f"{path}: unsupported type {type_}")
+            items.append(Item(kind, direction, type_, item_name, int(size or 0), default))
+        elif keyword == "variable":
+            match = re.match(r"variable (.+?) ?(\w+) ?(\[ ?\d+ ?\])? ?(?:= ?(.+))?$", statement)
+            if match is None:
+                sys.exit(f"{path}: can not parse '{statement}'")
+            variables.append(Variable(*match.groups()[:2], match.group(3) or "", match.group(4)))
+        elif keyword == "function":
+            functions.append(statement.split()[1])
+        elif keyword == "option":
+            words = statement.split()
+            options[words[1]] = words[2] if len(words) > 2 else "yes"
+        elif keyword == "include":
+            includes.append(statement.split(None, 1)[1])
+        elif keyword in ("license", "author", "description", "notes", "see_also", "examples"):
+            continue
+        else:
+            sys.exit(f"{path}: unsupported declaration '{keyword}'")
+
+    if name is None:
+        sys.exit(f"{path}: no component declaration")
+    if options.get("userspace", "no") != "no":
+        sys.exit(f"{path}: userspace components are not supported")
+
+    return Component(
+        name, items, variables, functions, options, includes, body, declarations.count("\n") + 3
+    )
+
+
+def item_macro(item: Item) -> str:
+    access = "__comp_inst->" + item.c_name
+    if item.size:
+        access += "[i]"
+    if item.kind == "pin":
+        access = ("0+*" if item.direction == "in" else "*") + access
+    argument = "(i)" if item.size else ""
+    return f"#define {item.c_name}{argument} ({access})\n"
+
+
+def generate_source(component: Component, path: pathlib.Path, header: str) -> str:
+    prefix = component.name + "_host"
+    lines = [
+        f"/* Generated by tools/hal/host_comp.py from {path.name}, do not edit */\n\n",
+        "#include <stdlib.h>\n#include <string.h>\n\n",
+        f'#define HAL_HOST_COMPONENT "{component.name}"\n',
+        '#include "rtapi.h"\n#include "rtapi_app.h"\n#include "hal.h"\n',
+        f'#include "{header}"\n',
+        *(f"#include {include}\n" for include in component.includes),
+        "\nstatic int comp_id __attribute__((unused));\n\nstruct __comp_state {\n",
+        "    int _personality;\n",
+    ]
+    for item in component.items:
+        pointer = "*" if item.kind == "pin" else ""
+        array = f"[{item.size}]" if item.size else ""
+        lines.append(f"    {C_TYPES[item.type]} {pointer}{item.c_name}{array};\n")
+    for variable in component.variables:
+        lines.append(f"    {variable.type} {variable.name}{variable.array};\n")
+    lines += [
+        "};\n\n",
+        "#define FUNCTION(name) static void name(struct __comp_state *__comp_inst, long period)\n",
+        "#define EXTRA_SETUP() static int extra_setup(struct __comp_state *__comp_inst, "
+        "char *prefix, long extra_arg)\n",
+        "#define EXTRA_CLEANUP() static void extra_cleanup(void)\n",
+        "#define fperiod (period * 1e-9)\n",
+        "#define personality (__comp_inst->_personality)\n",
+        *(item_macro(item) for item in component.items),
+        *(f"#define {v.name} (__comp_inst->{v.name})\n" for v in component.variables),
+        f'\n#line {component.body_line} "{path}"\n',
+        component.body,
+        "\n",
+        "#undef personality\n",
+        *(f"#undef {item.c_name}\n" for item in component.items),
+        *(f"#undef {v.name}\n" for v in component.variables),
+        f"\nstruct __comp_state *{prefix}_new(const char *prefix, long personality) {{\n",
+        "    struct __comp_state *inst = hal_malloc(sizeof(struct __comp_state));\n\n",
+        "    if (inst == NULL) {\n        return NULL;\n    }\n",
+        "    inst->_personality = (int)personality;\n",
+    ]
+    if component.options.get("extra_setup", "no") != "no":
+        lines.append("    if (extra_setup(inst, (char *)prefix, personality) != 0) {\n")
+        lines.append("        return NULL;\n    }\n")
+    for item in component.items:
+        element = f"inst->{item.c_name}" + ("[i]" if item.size else "")
+        loop = f"    for (int i = 0; i < {item.size}; i++)" if item.size else "   "
+        if item.kind == "pin":
+            lines.append(f"{loop} {{\n        {element} = hal_malloc(sizeof(*{element}));\n")
+            if item.default is not None:
+                lines.append(f"        *{element} = {item.default};\n")
+            lines.append("    }\n")
+        elif item.default is not None:
+            lines.append(f"{loop} {element} = {item.default};\n")
+    for variable in component.variables:
+        if variable.default is not None and not variable.array:
+            lines.append(f"    inst->{variable.name} = {variable.default};\n")
+    lines.append("    return inst;\n}\n")
+
+    for kind in ("pin", "param"):
+        lines.append(f"\nvoid *{prefix}_{kind}(struct __comp_state *inst, const char *name) {{\n")
+        for item in (item for item in component.items if item.kind == kind):
+            for index, hal_name in enumerate(item.hal_names()):
+                element = f"inst->{item.c_name}" + (f"[{index}]" if item.size else "")
+                lines.append(f'    if (strcmp(name, "{hal_name}") == 0) {{\n')
+                lines.append(f"        return (void *)&{element};\n    }}\n")
+        lines.append("    return NULL;\n}\n")
+
+    for kind in ("param", "pin"):
+        lines.append(
+            f"\nint {prefix}_set_{kind}(struct __comp_state *inst, const char *name, "
+            "double value) {\n"
+        )
+        for item in (item for item in component.items if item.kind == kind):
+            if kind == "pin" and item.direction not in ("in", "io"):
+                continue
+            for index, hal_name in enumerate(item.hal_names()):
+                element = f"inst->{item.c_name}" + (f"[{index}]" if item.size else "")
+                if kind == "pin":
+                    element = f"*{element}"
+                cast = "value != 0" if item.type == "bit" else f"({C_TYPES[item.type]})value"
+                lines.append(f'    if (strcmp(name, "{hal_name}") == 0) {{\n')
+                lines.append(f"        {element} = {cast};\n        return 0;\n    }}\n")
+        lines.append("    return -1;\n}\n")
+
+    for function in component.functions:
+        name = "run" if function == "_" else function.replace("-", "_")
+        lines.append(
+            f"\nvoid {prefix}_{name}(struct __comp_state *inst, long period) "
+            f"{{ {function}(inst, period); }}\n"
+        )
+    if component.options.get("extra_cleanup", "no") != "no":
+        lines.append(f"\nvoid {prefix}_cleanup(void) {{ extra_cleanup(); }}\n")
+    return "".join(lines)
+
+
+def generate_header(component: Component, path: pathlib.Path) -> str:
+    prefix = component.name + "_host"
+    guard = prefix.upper() + "_H"
+    lines = [
+        f"/* Generated by tools/hal/host_comp.py from {path.name}, do not edit */\n\n",
+        f"#ifndef {guard}\n#define {guard}\n\n",
+        "struct __comp_state;\n\n",
+        f"struct __comp_state *{prefix}_new(const char *prefix, long personality);\n",
+        f"void *{prefix}_pin(struct __comp_state *inst, const char *name);\n",
+        f"void *{prefix}_param(struct __comp_state *inst, const char *name);\n",
+        f"int {prefix}_set_param(struct __comp_state *inst, const char *name, double value);\n",
+        f"int {prefix}_set_pin(struct __comp_state *inst, const char *name, double value);\n",
+    ]
+    for function in component.functions:
+        name = "run" if function == "_" else function.replace("-", "_")
+        lines.append(f"void {prefix}_{name}(struct __comp_state *inst, long period);\n")
+    if component.options.get("extra_cleanup", "no") != "no":
+        lines.append(f"void {prefix}_cleanup(void);\n")
+    lines.append(f"\n#endif // {guard}\n")
+    return "".join(lines)
+
+
+def main() -> None:
+    if len(sys.argv) not in (3, 4):
+        sys.exit(__doc__)
+    path = pathlib.Path(sys.argv[1]).resolve()
+    source = pathlib.Path(sys.argv[2])
+    header = pathlib.Path(sys.argv[3]) if len(sys.argv) == 4 else source.with_suffix(".h")
+
+    component = parse(path)
+    header.write_text(generate_header(component, path))
+    source.write_text(generate_source(component, path, header.name))
+
+
+if __name__ == "__main__":
+    main()